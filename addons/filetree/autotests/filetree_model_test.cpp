@@ -459,6 +459,42 @@ void FileTreeModelTest::buildTreeBatchPrefill()
   qDeleteAll(documents);
 }
 
+void FileTreeModelTest::buildTreeBatchReset()
+{
+  // a batch this large is built with one model reset instead of row inserts
+  KateFileTreeModel m(this);
+  QList<DummyDocument *> documents;
+  documents << new DummyDocument("file:///a/prefill.txt");
+  m.documentOpened(documents.first());
+
+  ResultNode a("a", true);
+  ResultNode b("b", true);
+  a << ResultNode("prefill.txt");
+
+  QList<KTextEditor::Document *> list;
+  for (int i = 0; i < 40; i++) {
+    const QString name = QStringLiteral("file%1.txt").arg(i);
+    DummyDocument *doc = new DummyDocument(((i % 2) ? QStringLiteral("file:///b/") : QStringLiteral("file:///a/")) + name);
+    ((i % 2) ? b : a) << ResultNode(name);
+    documents << doc;
+    list << doc;
+  }
+
+  QSignalSpy resets(&m, SIGNAL(modelReset()));
+  QSignalSpy inserts(&m, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+  m.documentsOpened(list);
+
+  QCOMPARE(resets.count(), 1);
+  QCOMPARE(inserts.count(), 0);
+
+  ResultNode root;
+  walkTree(m, QModelIndex(), root);
+
+  QCOMPARE(root, ResultNode() << a << b);
+  qDeleteAll(documents);
+}
+
 void FileTreeModelTest::walkTree(KateFileTreeModel &model, const QModelIndex &rootIndex, ResultNode &rootNode)
 {
   if (!model.hasChildren(rootIndex)) {
@@ -911,4 +947,30 @@ void FileTreeModelTest::rename()
 }
 
 
+void FileTreeModelTest::benchmarkOpenClose()
+{
+  // 10k documents in a deep tree: 10 projects, 10 modules, 10 dirs, 10 files each
+  QList<DummyDocument *> documents;
+  for (int i = 0; i < 10000; i++) {
+    documents << new DummyDocument(QString::fromLatin1("file:///bench/project%1/module%2/dir%3/file%4.cpp")
+                                   .arg(i / 1000).arg((i / 100) % 10).arg((i / 10) % 10).arg(i % 10));
+  }
+
+  QBENCHMARK {
+    KateFileTreeModel m(this);
+
+    foreach (DummyDocument *doc, documents) {
+      m.documentOpened(doc);
+    }
+
+    foreach (DummyDocument *doc, documents) {
+      m.documentClosed(doc);
+    }
+
+    QCOMPARE(m.rowCount(QModelIndex()), 0);
+  }
+
+  qDeleteAll(documents);
+}
+
 // kate: space-indent on; indent-width 2; replace-tabs on;
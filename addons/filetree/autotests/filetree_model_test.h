@@ -44,6 +44,7 @@ class FileTreeModelTest : public QObject
     void buildTreeBatch();
     void buildTreeBatchPrefill_data();
     void buildTreeBatchPrefill();
+    void buildTreeBatchReset();
     
     void listMode_data();
     void listMode();
@@ -56,6 +57,8 @@ class FileTreeModelTest : public QObject
     void rename_data();
     void rename();
 
+    void benchmarkOpenClose();
+
   private:
     void walkTree(KateFileTreeModel &model, const QModelIndex &i, ResultNode &node);
 };
@@ -22,10 +22,13 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QList>
+#include <QMap>
 #include <QMimeDatabase>
 #include <QIcon>
 #include <QStack>
 
+#include <algorithm>
+
 #include <KColorScheme>
 #include <KColorUtils>
 #include <KLocalizedString>
@@ -37,13 +40,44 @@
 
 #include "katefiletreedebug.h"
 
+/**
+ * placeholder documents of a lazy session restore have no url yet and are not
+ * in documents(), kate offers extra application slots for them
+ */
+static QObject *kateApplication(const char *method)
+{
+    QObject *app = KTextEditor::Editor::instance()->application()->parent();
+    if (!app || app->metaObject()->indexOfMethod(QMetaObject::normalizedSignature(method).constData()) < 0) {
+        return nullptr;
+    }
+    return app;
+}
+
+static QUrl documentUrlOf(const KTextEditor::Document *doc)
+{
+    QUrl url = doc->url();
+    if (url.isEmpty()) {
+        if (QObject *app = kateApplication("documentUrl(KTextEditor::Document*)")) {
+            QMetaObject::invokeMethod(app, "documentUrl", Qt::DirectConnection, Q_RETURN_ARG(QUrl, url),
+                                      Q_ARG(KTextEditor::Document *, const_cast<KTextEditor::Document *>(doc)));
+        }
+    }
+    return url;
+}
+
+static QString documentNameOf(const KTextEditor::Document *doc)
+{
+    const QUrl placeholderUrl = doc->url().isEmpty() ? documentUrlOf(doc) : QUrl();
+    return placeholderUrl.isEmpty() ? doc->documentName() : placeholderUrl.fileName();
+}
+
 class ProxyItemDir;
 class ProxyItem
 {
     friend class KateFileTreeModel;
 
 public:
-    enum Flag { None = 0, Dir = 1, Modified = 2, ModifiedExternally = 4, DeletedExternally = 8, Empty = 16, ShowFullPath = 32, Host = 64 };
+    enum Flag { None = 0, Dir = 1, Modified = 2, ModifiedExternally = 4, DeletedExternally = 8, Empty = 16, ShowFullPath = 32, Host = 64, IconOutdated = 128 };
     Q_DECLARE_FLAGS(Flags, Flag)
 
     ProxyItem(const QString &n, ProxyItemDir *p = 0, Flags f = ProxyItem::None);
@@ -74,6 +108,26 @@ public:
     const QList<ProxyItem *> &children() const;
     QList<ProxyItem *> &children();
 
+    /**
+     * first child directory with the given display name
+     */
+    ProxyItemDir *dirChild(const QString &display) const;
+
+    /**
+     * child directories with the given display name, in row order
+     */
+    QList<ProxyItem *> dirChildrenWithDisplay(const QString &display) const;
+
+    /**
+     * children with the given path, in no particular order
+     */
+    QList<ProxyItem *> childrenWithPath(const QString &path) const;
+
+    /**
+     * children whose path starts with the given prefix, in row order
+     */
+    QList<ProxyItem *> childrenWithPathPrefix(const QString &prefix) const;
+
     void setDoc(KTextEditor::Document *doc);
     KTextEditor::Document *doc() const;
 
@@ -101,9 +155,20 @@ private:
     KTextEditor::Document *m_doc;
     QString m_host;
 
+    /**
+     * lookup of the children, kept current by add/remChild and
+     * whenever the path or display of a child changes
+     */
+    QMultiHash<QString, ProxyItem *> m_dirChildrenByDisplay;
+    QMultiMap<QString, ProxyItem *> m_childrenByPath;
+
 protected:
     void updateDisplay();
     void updateDocumentName();
+
+private:
+    void indexChild(ProxyItem *item);
+    void unindexChild(ProxyItem *item);
 };
 
 QDebug operator<<(QDebug dbg, ProxyItem *item)
@@ -172,6 +237,10 @@ ProxyItem::~ProxyItem()
 
 void ProxyItem::updateDisplay()
 {
+    if (m_parent) {
+        m_parent->unindexChild(this);
+    }
+
     // triggers only if this is a top level node and the root has the show full path flag set.
     if (flag(ProxyItem::Dir) && m_parent && !m_parent->m_parent && m_parent->flag(ProxyItem::ShowFullPath)) {
         m_display = m_path;
@@ -187,6 +256,62 @@ void ProxyItem::updateDisplay()
             }
         }
     }
+
+    if (m_parent) {
+        m_parent->indexChild(this);
+    }
+}
+
+void ProxyItem::indexChild(ProxyItem *item)
+{
+    m_childrenByPath.insert(item->m_path, item);
+    if (item->flag(ProxyItem::Dir)) {
+        m_dirChildrenByDisplay.insert(item->m_display, item);
+    }
+}
+
+void ProxyItem::unindexChild(ProxyItem *item)
+{
+    m_childrenByPath.remove(item->m_path, item);
+    m_dirChildrenByDisplay.remove(item->m_display, item);
+}
+
+ProxyItemDir *ProxyItem::dirChild(const QString &display) const
+{
+    ProxyItem *result = 0;
+    for (auto it = m_dirChildrenByDisplay.constFind(display); it != m_dirChildrenByDisplay.constEnd() && it.key() == display; ++it) {
+        if (!result || it.value()->row() < result->row()) {
+            result = it.value();
+        }
+    }
+    return static_cast<ProxyItemDir *>(result);
+}
+
+QList<ProxyItem *> ProxyItem::dirChildrenWithDisplay(const QString &display) const
+{
+    QList<ProxyItem *> result = m_dirChildrenByDisplay.values(display);
+    std::sort(result.begin(), result.end(), [](const ProxyItem *a, const ProxyItem *b) {
+        return a->row() < b->row();
+    });
+    return result;
+}
+
+QList<ProxyItem *> ProxyItem::childrenWithPath(const QString &path) const
+{
+    return m_childrenByPath.values(path);
+}
+
+QList<ProxyItem *> ProxyItem::childrenWithPathPrefix(const QString &prefix) const
+{
+    QList<ProxyItem *> result;
+    for (auto it = m_childrenByPath.lowerBound(prefix); it != m_childrenByPath.constEnd() && it.key().startsWith(prefix); ++it) {
+        result.append(it.value());
+    }
+
+    std::sort(result.begin(), result.end(), [](const ProxyItem *a, const ProxyItem *b) {
+        return a->row() < b->row();
+    });
+    return result;
 }
 
 int ProxyItem::addChild(ProxyItem *item)
@@ -208,9 +333,10 @@ int ProxyItem::addChild(ProxyItem *item)
 
 void ProxyItem::remChild(ProxyItem *item)
 {
-    const int idx = m_children.indexOf(item);
-    Q_ASSERT(idx != -1);
+    const int idx = item->m_row;
+    Q_ASSERT(idx >= 0 && idx < m_children.count() && m_children[idx] == item);
 
+    unindexChild(item);
     m_children.removeAt(idx);
 
     for (int i = idx; i < m_children.count(); i++) {
@@ -267,6 +393,10 @@ const QString &ProxyItem::path() const
 
 void ProxyItem::setPath(const QString &p)
 {
+    if (m_parent) {
+        m_parent->unindexChild(this);
+    }
+
     m_path = p;
     updateDisplay();
 }
@@ -350,7 +480,7 @@ const QString &ProxyItem::host() const
 
 void ProxyItem::updateDocumentName()
 {
-    const QString docName = m_doc ? m_doc->documentName() : QString();
+    const QString docName = m_doc ? documentNameOf(m_doc) : QString();
 
     if (flag(ProxyItem::Host)) {
         m_documentName = QString::fromLatin1("[%1]%2").arg(m_host).arg(docName);
@@ -364,6 +494,7 @@ void ProxyItem::updateDocumentName()
 KateFileTreeModel::KateFileTreeModel(QObject *p)
     : QAbstractItemModel(p)
     , m_root(new ProxyItemDir(QLatin1String("m_root"), 0))
+    , m_resetting(false)
 {
     // setup default settings
     // session init will set these all soon
@@ -435,8 +566,12 @@ void KateFileTreeModel::setShowFullPathOnRoots(bool s)
 
 void KateFileTreeModel::initModel()
 {
-    // add already existing documents
-    foreach(KTextEditor::Document * doc, KTextEditor::Editor::instance()->application()->documents()) {
+    // add already existing documents, with the placeholders if the application has them
+    QList<KTextEditor::Document *> documents = KTextEditor::Editor::instance()->application()->documents();
+    if (QObject *app = kateApplication("documentsWithPlaceholders()")) {
+        QMetaObject::invokeMethod(app, "documentsWithPlaceholders", Qt::DirectConnection, Q_RETURN_ARG(QList<KTextEditor::Document *>, documents));
+    }
+    foreach(KTextEditor::Document * doc, documents) {
         documentOpened(doc);
     }
 }
@@ -446,7 +581,7 @@ void KateFileTreeModel::clearModel()
     // remove all items
     // can safely ignore documentClosed here
 
-    beginRemoveRows(QModelIndex(), 0, qMax(m_root->childCount() - 1, 0));
+    beginRemoveItems(QModelIndex(), 0, qMax(m_root->childCount() - 1, 0));
 
     delete m_root;
     m_root = new ProxyItemDir(QLatin1String("m_root"), 0);
@@ -456,7 +591,7 @@ void KateFileTreeModel::clearModel()
     m_editHistory.clear();
     m_brushes.clear();
 
-    endRemoveRows();
+    endRemoveItems();
 }
 
 void KateFileTreeModel::connectDocument(const KTextEditor::Document *doc)
@@ -511,7 +646,7 @@ QVariant KateFileTreeModel::data(const QModelIndex &index, int role) const
     switch (role) {
     case KateFileTreeModel::PathRole:
         // allow to sort with hostname + path, bug 271488
-        return (item->doc() && !item->doc()->url().isEmpty()) ? item->doc()->url().toString() : item->path();
+        return (item->doc() && !documentUrlOf(item->doc()).isEmpty()) ? documentUrlOf(item->doc()).toString() : item->path();
 
     case KateFileTreeModel::DocumentRole:
         return QVariant::fromValue(item->doc());
@@ -531,6 +666,9 @@ QVariant KateFileTreeModel::data(const QModelIndex &index, int role) const
         }
 
     case Qt::DecorationRole:
+        if (item->flag(ProxyItem::IconOutdated)) {
+            updateIcon(item);
+        }
         return item->icon();
 
     case Qt::ToolTipRole: {
@@ -696,13 +834,33 @@ void KateFileTreeModel::documentOpened(KTextEditor::Document *doc)
 
 void KateFileTreeModel::documentsOpened(const QList<KTextEditor::Document *> &docs)
 {
+    // large batches, like a restored session, are built without notifying
+    // the views and published with one reset instead of one insert per item
+    static const int ResetThreshold = 32;
+    const bool reset = docs.count() >= ResetThreshold;
+    if (reset) {
+        beginResetModel();
+        m_resetting = true;
+    }
+
+    bool nameChanged = false;
     foreach(KTextEditor::Document * doc, docs) {
         if (m_docmap.contains(doc)) {
             documentNameChanged(doc);
+            nameChanged = true;
         } else {
             documentOpened(doc);
         }
     }
+
+    if (reset) {
+        m_resetting = false;
+        endResetModel();
+
+        if (nameChanged) {
+            emit triggerViewChangeAfterNameChange();
+        }
+    }
 }
 
 void KateFileTreeModel::documentModifiedChanged(KTextEditor::Document *doc)
@@ -765,8 +923,15 @@ void KateFileTreeModel::documentActivated(const KTextEditor::Document *doc)
         return;
     }
 
+    // already the most recent one => no rank changes
     ProxyItem *item = m_docmap[doc];
-    m_viewHistory.removeAll(item);
+    const int pos = m_viewHistory.indexOf(item);
+    if (pos == 0) {
+        return;
+    }
+    if (pos > 0) {
+        m_viewHistory.removeAt(pos);
+    }
     m_viewHistory.prepend(item);
 
     while (m_viewHistory.count() > 10) {
@@ -782,8 +947,15 @@ void KateFileTreeModel::documentEdited(const KTextEditor::Document *doc)
         return;
     }
 
+    // already the most recent one => no rank changes
     ProxyItem *item = m_docmap[doc];
-    m_editHistory.removeAll(item);
+    const int pos = m_editHistory.indexOf(item);
+    if (pos == 0) {
+        return;
+    }
+    if (pos > 0) {
+        m_editHistory.removeAt(pos);
+    }
     m_editHistory.prepend(item);
     while (m_editHistory.count() > 10) {
         m_editHistory.removeLast();
@@ -810,48 +982,28 @@ void KateFileTreeModel::slotDocumentsDeleted(const QList<KTextEditor::Document *
     }
 }
 
-class EditViewCount
-{
-public:
-    EditViewCount(): edit(0), view(0)
-    {}
-    int edit;
-    int view;
-};
-
 void KateFileTreeModel::updateBackgrounds(bool force)
 {
     if (!m_shadingEnabled && !force) {
         return;
     }
 
-    QMap <ProxyItem *, EditViewCount> helper;
-    int i = 1;
-
-    foreach(ProxyItem * item, m_viewHistory) {
-        helper[item].view = i;
-        i++;
-    }
-
-    i = 1;
-    foreach(ProxyItem * item, m_editHistory) {
-        helper[item].edit = i;
-        i++;
-    }
-
-    QMap<ProxyItem *, QBrush> oldBrushes = m_brushes;
-    m_brushes.clear();
+    // only the few items in the histories have a brush, their rank is the position in the history
+    QHash<ProxyItem *, QBrush> oldBrushes;
+    oldBrushes.swap(m_brushes);
 
     const int hc = m_viewHistory.count();
     const int ec = m_editHistory.count();
+    const QColor base = QPalette().color(QPalette::Base);
 
-    for (QMap<ProxyItem *, EditViewCount>::iterator it = helper.begin(); it != helper.end(); ++it) {
+    // ranks are 1-based, 0 if not in that history
+    auto brush = [&](int view, int edit) {
         QColor shade(m_viewShade);
         QColor eshade(m_editShade);
 
-        if (it.value().edit > 0) {
-            int v = hc - it.value().view;
-            int e = ec - it.value().edit + 1;
+        if (edit > 0) {
+            int v = hc - view;
+            int e = ec - edit + 1;
 
             e = e * e;
 
@@ -865,20 +1017,56 @@ void KateFileTreeModel::updateBackgrounds(bool force)
         }
 
         // blend in the shade color; latest is most colored.
-        const double t = double(hc - it.value().view + 1) / double(hc);
+        const double t = double(hc - view + 1) / double(hc);
 
-        m_brushes[it.key()] = QBrush(KColorUtils::mix(QPalette().color(QPalette::Base), shade, t));
+        return QBrush(KColorUtils::mix(base, shade, t));
+    };
+
+    for (int view = 1; view <= hc; ++view) {
+        ProxyItem *item = m_viewHistory.at(view - 1);
+        m_brushes[item] = brush(view, m_editHistory.indexOf(item) + 1);
     }
 
-    foreach(ProxyItem * item, m_brushes.keys()) {
-        oldBrushes.remove(item);
-        const QModelIndex idx = createIndex(item->row(), 0, item);
-        dataChanged(idx, idx);
+    for (int edit = 1; edit <= ec; ++edit) {
+        ProxyItem *item = m_editHistory.at(edit - 1);
+        if (!m_brushes.contains(item)) {
+            m_brushes[item] = brush(0, edit);
+        }
     }
 
-    foreach(ProxyItem * item, oldBrushes.keys()) {
-        const QModelIndex idx = createIndex(item->row(), 0, item);
-        dataChanged(idx, idx);
+    // only items whose brush really changed need a repaint
+    QList<ProxyItem *> dirty;
+    for (auto it = m_brushes.constBegin(); it != m_brushes.constEnd(); ++it) {
+        const auto old = oldBrushes.constFind(it.key());
+        if (old == oldBrushes.constEnd() || old.value() != it.value()) {
+            dirty.append(it.key());
+        }
+    }
+    for (auto it = oldBrushes.constBegin(); it != oldBrushes.constEnd(); ++it) {
+        if (!m_brushes.contains(it.key())) {
+            dirty.append(it.key());
+        }
+    }
+
+    emitBackgroundsChanged(dirty);
+}
+
+void KateFileTreeModel::emitBackgroundsChanged(QList<ProxyItem *> items)
+{
+    // coalesce siblings with adjacent rows into one range
+    std::sort(items.begin(), items.end(), [](const ProxyItem *a, const ProxyItem *b) {
+        return (a->parent() != b->parent()) ? (a->parent() < b->parent()) : (a->row() < b->row());
+    });
+
+    const QVector<int> roles(1, Qt::BackgroundRole);
+    for (int i = 0; i < items.count();) {
+        int j = i + 1;
+        while (j < items.count() && items[j]->parent() == items[i]->parent() && items[j]->row() == items[j - 1]->row() + 1) {
+            ++j;
+        }
+
+        emit dataChanged(createIndex(items[i]->row(), 0, items[i]), createIndex(items[j - 1]->row(), 0, items[j - 1]), roles);
+        i = j;
     }
 }
 
@@ -895,9 +1083,9 @@ void KateFileTreeModel::handleEmptyParents(ProxyItemDir *item)
     while (parent) {
         if (!item->childCount()) {
             const QModelIndex parent_index = (parent == m_root) ? QModelIndex() : createIndex(parent->row(), 0, parent);
-            beginRemoveRows(parent_index, item->row(), item->row());
+            beginRemoveItems(parent_index, item->row(), item->row());
             parent->remChild(item);
-            endRemoveRows();
+            endRemoveItems();
             delete item;
         } else {
             // breakout early, if this node isn't empty, theres no use in checking its parents
@@ -917,26 +1105,18 @@ void KateFileTreeModel::documentClosed(KTextEditor::Document *doc)
 
     if (m_shadingEnabled) {
         ProxyItem *toRemove = m_docmap[doc];
-        if (m_brushes.contains(toRemove)) {
-            m_brushes.remove(toRemove);
-        }
-
-        if (m_viewHistory.contains(toRemove)) {
-            m_viewHistory.removeAll(toRemove);
-        }
-
-        if (m_editHistory.contains(toRemove)) {
-            m_editHistory.removeAll(toRemove);
-        }
+        m_brushes.remove(toRemove);
+        m_viewHistory.removeOne(toRemove);
+        m_editHistory.removeOne(toRemove);
     }
 
     ProxyItem *node = m_docmap[doc];
     ProxyItemDir *parent = node->parent();
 
     const QModelIndex parent_index = (parent == m_root) ? QModelIndex() : createIndex(parent->row(), 0, parent);
-    beginRemoveRows(parent_index, node->row(), node->row());
+    beginRemoveItems(parent_index, node->row(), node->row());
     node->parent()->remChild(node);
-    endRemoveRows();
+    endRemoveItems();
 
     delete node;
     handleEmptyParents(parent);
@@ -952,53 +1132,28 @@ void KateFileTreeModel::documentNameChanged(KTextEditor::Document *doc)
 
     ProxyItem *item = m_docmap[doc];
 
-    if (m_shadingEnabled) {
-        ProxyItem *toRemove = m_docmap[doc];
-        if (m_brushes.contains(toRemove)) {
-            QBrush brush = m_brushes[toRemove];
-            m_brushes.remove(toRemove);
-            m_brushes.insert(item, brush);
-        }
-
-        if (m_viewHistory.contains(toRemove)) {
-            const int idx = m_viewHistory.indexOf(toRemove);
-            if (idx != -1) {
-                m_viewHistory.replace(idx, item);
-            }
-        }
-
-        if (m_editHistory.contains(toRemove)) {
-            const int idx = m_editHistory.indexOf(toRemove);
-            if (idx != -1) {
-                m_editHistory.replace(idx, item);
-            }
-        }
-    }
-
     handleNameChange(item);
-    emit triggerViewChangeAfterNameChange(); // FIXME: heh, non-standard signal?
+    if (!m_resetting) {
+        emit triggerViewChangeAfterNameChange(); // FIXME: heh, non-standard signal?
+    }
 }
 
-ProxyItemDir *KateFileTreeModel::findRootNode(const QString &name, const int r) const
+ProxyItemDir *KateFileTreeModel::findRootNode(const QString &name) const
 {
-    foreach(ProxyItem * item, m_root->children()) {
-        if (!item->flag(ProxyItem::Dir)) {
-            continue;
-        }
-
-        // make sure we're actually matching against the right dir,
-        // previously the check below would match /foo/xy against /foo/x
-        // and return /foo/x rather than /foo/xy
-        // this seems a bit hackish, but is the simplest way to solve the
-        // current issue.
-        QString path = item->path().section(QLatin1Char('/'), 0, -r) + QLatin1Char('/');
-
-        if (name.startsWith(path)) {
-            return static_cast<ProxyItemDir *>(item);
+    // every directory above name might be a root, the first one wins.
+    // match full dirs only, /foo/xy must not match the root /foo/x
+    ProxyItem *result = 0;
+    int pos = 0;
+    while ((pos = name.indexOf(QLatin1Char('/'), pos)) != -1) {
+        foreach(ProxyItem * item, m_root->childrenWithPath(name.left(pos))) {
+            if (item->flag(ProxyItem::Dir) && (!result || item->row() < result->row())) {
+                result = item;
+            }
         }
+        ++pos;
     }
 
-    return 0;
+    return static_cast<ProxyItemDir *>(result);
 }
 
 ProxyItemDir *KateFileTreeModel::findChildNode(const ProxyItemDir *parent, const QString &name) const
@@ -1006,21 +1161,7 @@ ProxyItemDir *KateFileTreeModel::findChildNode(const ProxyItemDir *parent, const
     Q_ASSERT(parent != 0);
     Q_ASSERT(!name.isEmpty());
 
-    if (!parent->childCount()) {
-        return 0;
-    }
-
-    foreach(ProxyItem * item, parent->children()) {
-        if (!item->flag(ProxyItem::Dir)) {
-            continue;
-        }
-
-        if (item->display() == name) {
-            return static_cast<ProxyItemDir *>(item);
-        }
-    }
-
-    return 0;
+    return parent->dirChild(name);
 }
 
 void KateFileTreeModel::insertItemInto(ProxyItemDir *root, ProxyItem *item)
@@ -1046,18 +1187,18 @@ void KateFileTreeModel::insertItemInto(ProxyItemDir *root, ProxyItem *item)
         if (!find) {
             const QString new_name = current_parts.join(QLatin1String("/"));
             const QModelIndex parent_index = (ptr == m_root) ? QModelIndex() : createIndex(ptr->row(), 0, ptr);
-            beginInsertRows(parent_index, ptr->childCount(), ptr->childCount());
+            beginInsertItems(parent_index, ptr->childCount(), ptr->childCount());
             ptr = new ProxyItemDir(new_name, ptr);
-            endInsertRows();
+            endInsertItems();
         } else {
             ptr = find;
         }
     }
 
     const QModelIndex parent_index = (ptr == m_root) ? QModelIndex() : createIndex(ptr->row(), 0, ptr);
-    beginInsertRows(parent_index, ptr->childCount(), ptr->childCount());
+    beginInsertItems(parent_index, ptr->childCount(), ptr->childCount());
     ptr->addChild(item);
-    endInsertRows();
+    endInsertItems();
 }
 
 void KateFileTreeModel::handleInsert(ProxyItem *item)
@@ -1065,9 +1206,9 @@ void KateFileTreeModel::handleInsert(ProxyItem *item)
     Q_ASSERT(item != 0);
 
     if (m_listMode || item->flag(ProxyItem::Empty)) {
-        beginInsertRows(QModelIndex(), m_root->childCount(), m_root->childCount());
+        beginInsertItems(QModelIndex(), m_root->childCount(), m_root->childCount());
         m_root->addChild(item);
-        endInsertRows();
+        endInsertItems();
         return;
     }
 
@@ -1086,37 +1227,37 @@ void KateFileTreeModel::handleInsert(ProxyItem *item)
     new_root->setHost(item->host());
 
     // add new root to m_root
-    beginInsertRows(QModelIndex(), m_root->childCount(), m_root->childCount());
+    beginInsertItems(QModelIndex(), m_root->childCount(), m_root->childCount());
     m_root->addChild(new_root);
-    endInsertRows();
+    endInsertItems();
 
     // same fix as in findRootNode, try to match a full dir, instead of a partial path
     base += QLatin1Char('/');
 
     // try and merge existing roots with the new root node (new_root.path < root.path)
-    foreach(ProxyItem * root, m_root->children()) {
+    foreach(ProxyItem * root, m_root->childrenWithPathPrefix(base)) {
         if (root == new_root || !root->flag(ProxyItem::Dir)) {
             continue;
         }
 
         if (root->path().startsWith(base)) {
-            beginRemoveRows(QModelIndex(), root->row(), root->row());
+            beginRemoveItems(QModelIndex(), root->row(), root->row());
             m_root->remChild(root);
-            endRemoveRows();
+            endRemoveItems();
 
-            //beginInsertRows(new_root_index, new_root->childCount(), new_root->childCount());
+            //beginInsertItems(new_root_index, new_root->childCount(), new_root->childCount());
             // this can't use new_root->addChild directly, or it'll potentially miss a bunch of subdirs
             insertItemInto(new_root, root);
-            //endInsertRows();
+            //endInsertItems();
         }
     }
 
     // add item to new root
     // have to call begin/endInsertRows here, or the new item won't show up.
     const QModelIndex new_root_index = createIndex(new_root->row(), 0, new_root);
-    beginInsertRows(new_root_index, new_root->childCount(), new_root->childCount());
+    beginInsertItems(new_root_index, new_root->childCount(), new_root->childCount());
     new_root->addChild(item);
-    endInsertRows();
+    endInsertItems();
 
     handleDuplicitRootDisplay(new_root);
 }
@@ -1134,7 +1275,7 @@ void KateFileTreeModel::handleDuplicitRootDisplay(ProxyItemDir *init)
             continue;
         }
 
-        foreach(ProxyItem * root, m_root->children()) {
+        foreach(ProxyItem * root, m_root->dirChildrenWithDisplay(check_root->display())) {
             if (root == check_root || !root->flag(ProxyItem::Dir)) {
                 continue;
             }
@@ -1145,29 +1286,29 @@ void KateFileTreeModel::handleDuplicitRootDisplay(ProxyItemDir *init)
 
                 const QString rdir = root->path().section(QLatin1Char('/'), 0, -2);
                 if (!rdir.isEmpty()) {
-                    beginRemoveRows(QModelIndex(), root->row(), root->row());
+                    beginRemoveItems(QModelIndex(), root->row(), root->row());
                     m_root->remChild(root);
-                    endRemoveRows();
+                    endRemoveItems();
 
                     ProxyItemDir *irdir = new ProxyItemDir(rdir);
-                    beginInsertRows(QModelIndex(), m_root->childCount(), m_root->childCount());
+                    beginInsertItems(QModelIndex(), m_root->childCount(), m_root->childCount());
                     m_root->addChild(irdir);
-                    endInsertRows();
+                    endInsertItems();
 
                     insertItemInto(irdir, root);
 
-                    foreach(ProxyItem * node, m_root->children()) {
+                    const QString xy = rdir + QLatin1Char('/');
+                    foreach(ProxyItem * node, m_root->childrenWithPathPrefix(xy)) {
                         if (node == irdir || !root->flag(ProxyItem::Dir)) {
                             continue;
                         }
 
-                        const QString xy = rdir + QLatin1Char('/');
                         if (node->path().startsWith(xy)) {
-                            beginRemoveRows(QModelIndex(), node->row(), node->row());
+                            beginRemoveItems(QModelIndex(), node->row(), node->row());
                             // check_root_removed must be sticky
                             check_root_removed = check_root_removed || (node == check_root);
                             m_root->remChild(node);
-                            endRemoveRows();
+                            endRemoveItems();
                             insertItemInto(irdir, node);
                         }
                     }
@@ -1179,14 +1320,14 @@ void KateFileTreeModel::handleDuplicitRootDisplay(ProxyItemDir *init)
                 if (!check_root_removed) {
                     const QString nrdir = check_root->path().section(QLatin1Char('/'), 0, -2);
                     if (!nrdir.isEmpty()) {
-                        beginRemoveRows(QModelIndex(), check_root->row(), check_root->row());
+                        beginRemoveItems(QModelIndex(), check_root->row(), check_root->row());
                         m_root->remChild(check_root);
-                        endRemoveRows();
+                        endRemoveItems();
 
                         ProxyItemDir *irdir = new ProxyItemDir(nrdir);
-                        beginInsertRows(QModelIndex(), m_root->childCount(), m_root->childCount());
+                        beginInsertItems(QModelIndex(), m_root->childCount(), m_root->childCount());
                         m_root->addChild(irdir);
-                        endInsertRows();
+                        endInsertItems();
 
                         insertItemInto(irdir, check_root);
 
@@ -1213,9 +1354,11 @@ void KateFileTreeModel::handleNameChange(ProxyItem *item)
     updateItemPathAndHost(item);
 
     if (m_listMode) {
-        const QModelIndex idx = createIndex(item->row(), 0, item);
         setupIcon(item);
-        emit dataChanged(idx, idx);
+        if (!m_resetting) {
+            const QModelIndex idx = createIndex(item->row(), 0, item);
+            emit dataChanged(idx, idx);
+        }
         return;
     }
 
@@ -1223,9 +1366,9 @@ void KateFileTreeModel::handleNameChange(ProxyItem *item)
     ProxyItemDir *parent = item->parent();
 
     const QModelIndex parent_index = (parent == m_root) ? QModelIndex() : createIndex(parent->row(), 0, parent);
-    beginRemoveRows(parent_index, item->row(), item->row());
+    beginRemoveItems(parent_index, item->row(), item->row());
     parent->remChild(item);
-    endRemoveRows();
+    endRemoveItems();
 
     handleEmptyParents(parent);
 
@@ -1245,14 +1388,15 @@ void KateFileTreeModel::updateItemPathAndHost(ProxyItem *item) const
     const KTextEditor::Document *doc = item->doc();
     Q_ASSERT(doc); // this method should not be called at directory items
 
-    QString path = doc->url().path();
+    const QUrl url = documentUrlOf(doc);
+    QString path = url.path();
     QString host;
-    if (doc->url().isEmpty()) {
+    if (url.isEmpty()) {
         path = doc->documentName();
         item->setFlag(ProxyItem::Empty);
     } else {
         item->clearFlag(ProxyItem::Empty);
-        host = doc->url().host();
+        host = url.host();
         if (!host.isEmpty()) {
             path = QString::fromLatin1("[%1]%2").arg(host).arg(path);
         }
@@ -1271,6 +1415,16 @@ void KateFileTreeModel::setupIcon(ProxyItem *item) const
 {
     Q_ASSERT(item != 0);
 
+    // the mime type lookup is expensive, only do it once the icon is shown
+    item->setFlag(ProxyItem::IconOutdated);
+}
+
+void KateFileTreeModel::updateIcon(ProxyItem *item) const
+{
+    Q_ASSERT(item != 0);
+
+    item->clearFlag(ProxyItem::IconOutdated);
+
     QString icon_name;
 
     if (item->flag(ProxyItem::Modified)) {
@@ -1298,9 +1452,33 @@ void KateFileTreeModel::resetHistory()
     m_editHistory.clear();
     m_brushes.clear();
 
-    foreach(ProxyItem * item, list) {
-        QModelIndex idx = createIndex(item->row(), 0, item);
-        dataChanged(idx, idx, QVector<int>(1, Qt::BackgroundRole));
+    emitBackgroundsChanged(list.toList());
+}
+
+void KateFileTreeModel::beginInsertItems(const QModelIndex &parent, int first, int last)
+{
+    if (!m_resetting) {
+        beginInsertRows(parent, first, last);
     }
 }
 
+void KateFileTreeModel::endInsertItems()
+{
+    if (!m_resetting) {
+        endInsertRows();
+    }
+}
+
+void KateFileTreeModel::beginRemoveItems(const QModelIndex &parent, int first, int last)
+{
+    if (!m_resetting) {
+        beginRemoveRows(parent, first, last);
+    }
+}
+
+void KateFileTreeModel::endRemoveItems()
+{
+    if (!m_resetting) {
+        endRemoveRows();
+    }
+}
@@ -21,6 +21,7 @@
 #define KATEFILETREEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QBrush>
 #include <QColor>
 
 #include <ktexteditor/modificationinterface.h>
@@ -95,22 +96,33 @@ Q_SIGNALS:
     void triggerViewChangeAfterNameChange();
 
 private:
-    ProxyItemDir *findRootNode(const QString &name, const int r = 1) const;
+    ProxyItemDir *findRootNode(const QString &name) const;
     ProxyItemDir *findChildNode(const ProxyItemDir *parent, const QString &name) const;
     void insertItemInto(ProxyItemDir *root, ProxyItem *item);
     void handleInsert(ProxyItem *item);
     void handleNameChange(ProxyItem *item);
     void handleEmptyParents(ProxyItemDir *item);
     void setupIcon(ProxyItem *item) const;
+    void updateIcon(ProxyItem *item) const;
     void updateItemPathAndHost(ProxyItem *item) const;
     void handleDuplicitRootDisplay(ProxyItemDir *item);
 
     void updateBackgrounds(bool force = false);
+    void emitBackgroundsChanged(QList<ProxyItem *> items);
 
     void initModel();
     void clearModel();
     void connectDocument(const KTextEditor::Document *);
 
+    /**
+     * begin/endInsertRows and begin/endRemoveRows, suppressed while
+     * a batch is built for a model reset
+     */
+    void beginInsertItems(const QModelIndex &parent, int first, int last);
+    void endInsertItems();
+    void beginRemoveItems(const QModelIndex &parent, int first, int last);
+    void endRemoveItems();
+
 private:
     ProxyItemDir *m_root;
     QHash<const KTextEditor::Document *, ProxyItem *> m_docmap;
@@ -119,12 +131,17 @@ private:
 
     QList<ProxyItem *> m_viewHistory;
     QList<ProxyItem *> m_editHistory;
-    QMap<ProxyItem *, QBrush> m_brushes;
+    QHash<ProxyItem *, QBrush> m_brushes;
 
     QColor m_editShade;
     QColor m_viewShade;
 
     bool m_listMode;
+
+    /**
+     * true while documentsOpened() builds a batch inside a model reset
+     */
+    bool m_resetting;
 };
 
 #endif /* KATEFILETREEMODEL_H */
@@ -0,0 +1,267 @@
+/* Description : Kate CTags plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ctagsdatabase.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+/**
+ * process wide cache of loaded databases
+ */
+struct CTagsDatabaseCache
+{
+    QMutex mutex;
+    QHash<QString, QSharedPointer<const CTagsDatabase> > databases;
+};
+
+Q_GLOBAL_STATIC(CTagsDatabaseCache, s_cache)
+}
+
+/******************************************************************/
+QSharedPointer<const CTagsDatabase> CTagsDatabase::get(const QString &fileName)
+{
+    if (fileName.isEmpty()) {
+        return QSharedPointer<const CTagsDatabase>();
+    }
+
+    QMutexLocker locker(&s_cache->mutex);
+
+    const QFileInfo info(fileName);
+    if (!info.isFile()) {
+        s_cache->databases.remove(fileName);
+        return QSharedPointer<const CTagsDatabase>();
+    }
+
+    // reuse the loaded database as long as the file is unchanged
+    QSharedPointer<const CTagsDatabase> database = s_cache->databases.value(fileName);
+    if (database && database->m_modified == info.lastModified() && database->m_size == info.size()) {
+        return database;
+    }
+
+    // old instances stay alive as long as somebody still uses them
+    QSharedPointer<CTagsDatabase> loaded(new CTagsDatabase(fileName));
+    loaded->m_modified = info.lastModified();
+    if (!loaded->m_data) {
+        s_cache->databases.remove(fileName);
+        return QSharedPointer<const CTagsDatabase>();
+    }
+
+    s_cache->databases.insert(fileName, loaded);
+    return loaded;
+}
+
+/******************************************************************/
+CTagsDatabase::CTagsDatabase(const QString &fileName)
+: m_file(fileName)
+, m_data(0)
+, m_size(0)
+{
+    // offsets are 32 bit
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() <= 0 || m_file.size() >= 0xffffffffLL) {
+        return;
+    }
+
+    m_size = m_file.size();
+    m_data = reinterpret_cast<const char *>(m_file.map(0, m_size));
+    if (!m_data) {
+        return;
+    }
+
+    buildIndex();
+}
+
+/******************************************************************/
+CTagsDatabase::~CTagsDatabase()
+{
+    if (m_data) {
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+    }
+}
+
+/******************************************************************/
+void CTagsDatabase::buildIndex()
+{
+    // tags files are usually sorted already, only sort if needed
+    bool sorted = true;
+    quint32 offset = 0;
+    while (offset < m_size) {
+        const char *end = lineEnd(offset);
+        const char *line = m_data + offset;
+        const quint32 next = quint32(end - m_data) + 1;
+
+        // skip empty lines and pseudo tags like !_TAG_FILE_SORTED
+        if (end == line || *line == '\r' || (end - line >= 2 && line[0] == '!' && line[1] == '_')) {
+            offset = next;
+            continue;
+        }
+
+        if (sorted && !m_index.isEmpty() && compareName(offset, m_data + m_index.last(), nameLength(m_index.last())) < 0) {
+            sorted = false;
+        }
+
+        m_index.append(offset);
+        offset = next;
+    }
+
+    if (!sorted) {
+        std::stable_sort(m_index.begin(), m_index.end(), [this](quint32 a, quint32 b) {
+            return compareName(a, m_data + b, nameLength(b)) < 0;
+        });
+    }
+
+    m_index.squeeze();
+}
+
+/******************************************************************/
+const char *CTagsDatabase::lineEnd(quint32 offset) const
+{
+    const char *end = static_cast<const char *>(memchr(m_data + offset, '\n', m_size - offset));
+    return end ? end : m_data + m_size;
+}
+
+/******************************************************************/
+int CTagsDatabase::nameLength(quint32 offset) const
+{
+    const char *line = m_data + offset;
+    const char *end = lineEnd(offset);
+    const char *tab = static_cast<const char *>(memchr(line, '\t', end - line));
+    return (tab ? tab : end) - line;
+}
+
+/******************************************************************/
+int CTagsDatabase::compareName(quint32 offset, const char *name, int length) const
+{
+    const int ownLength = nameLength(offset);
+    const int result = memcmp(m_data + offset, name, qMin(ownLength, length));
+    return result ? result : ownLength - length;
+}
+
+/******************************************************************/
+QVector<quint32>::const_iterator CTagsDatabase::lowerBound(const QByteArray &name) const
+{
+    return std::lower_bound(m_index.constBegin(), m_index.constEnd(), name, [this](quint32 offset, const QByteArray &name) {
+        return compareName(offset, name.constData(), name.size()) < 0;
+    });
+}
+
+/******************************************************************/
+bool CTagsDatabase::matches(quint32 offset, const QByteArray &name, bool partial) const
+{
+    const int length = nameLength(offset);
+    if (partial ? (length < name.size()) : (length != name.size())) {
+        return false;
+    }
+    return memcmp(m_data + offset, name.constData(), name.size()) == 0;
+}
+
+/******************************************************************/
+int CTagsDatabase::count(const QByteArray &name, bool partial) const
+{
+    int n = 0;
+    for (auto it = lowerBound(name); it != m_index.constEnd() && matches(*it, name, partial); ++it) {
+        ++n;
+    }
+    return n;
+}
+
+/******************************************************************/
+QVector<CTagsDatabase::Entry> CTagsDatabase::find(const QByteArray &name, bool partial, const QList<QByteArray> &kinds) const
+{
+    QVector<Entry> entries;
+    for (auto it = lowerBound(name); it != m_index.constEnd() && matches(*it, name, partial); ++it) {
+        const Entry entry = entryAt(*it);
+        if (kinds.isEmpty() || kinds.contains(entry.kind)) {
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
+
+/******************************************************************/
+CTagsDatabase::Entry CTagsDatabase::entryAt(quint32 offset) const
+{
+    // format: name<TAB>file<TAB>address[;"<TAB>field...]
+    Entry entry;
+    entry.line = 0;
+
+    const char *p = m_data + offset;
+    const char *end = lineEnd(offset);
+    if (end > p && end[-1] == '\r') {
+        --end;
+    }
+
+    auto field = [&p, end]() {
+        const char *tab = static_cast<const char *>(memchr(p, '\t', end - p));
+        const char *fieldEnd = tab ? tab : end;
+        const QByteArray value = QByteArray::fromRawData(p, fieldEnd - p);
+        p = tab ? tab + 1 : end;
+        return value;
+    };
+
+    entry.name = field();
+    entry.file = field();
+
+    // the address is a search pattern, which may contain tabs, or a line number
+    const char *address = p;
+    if (p < end && (*p == '/' || *p == '?')) {
+        const char delimiter = *p++;
+        while (p < end && *p != delimiter) {
+            p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+        }
+        if (p < end) {
+            ++p;
+        }
+    } else {
+        while (p < end && *p >= '0' && *p <= '9') {
+            entry.line = entry.line * 10 + (*p++ - '0');
+        }
+    }
+    entry.pattern = QByteArray::fromRawData(address, p - address);
+
+    // extension fields: kind, either plain or as kind:, and line:
+    if (end - p >= 2 && p[0] == ';' && p[1] == '"') {
+        p += 2;
+        if (p < end && *p == '\t') {
+            ++p;
+        }
+        while (p < end) {
+            const QByteArray value = field();
+            const int colon = value.indexOf(':');
+            if (colon < 0) {
+                if (entry.kind.isEmpty()) {
+                    entry.kind = value;
+                }
+            } else if (value.startsWith("kind:")) {
+                entry.kind = value.mid(colon + 1);
+            } else if (value.startsWith("line:")) {
+                entry.line = value.mid(colon + 1).toInt();
+            }
+        }
+    }
+
+    return entry;
+}
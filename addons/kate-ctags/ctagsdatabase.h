@@ -0,0 +1,115 @@
+/* Description : Kate CTags plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CTAGS_DATABASE_H
+#define CTAGS_DATABASE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+#include <QVector>
+
+/**
+ * Read-only view of one tags file.
+ *
+ * The file is memory mapped once, an index of the entry offsets sorted by
+ * tag name answers exact and prefix queries by binary search.
+ * Databases are shared process wide: get() hands out the cached instance
+ * and only reloads it once the file changed on disk.
+ *
+ * The tags file must be replaced by renaming a new file over it, not
+ * rewritten in place, as long as it is mapped.
+ */
+class CTagsDatabase
+{
+public:
+    /**
+     * One parsed tags file entry.
+     * The fields point into the mapped file without copying,
+     * they are only valid as long as the database lives.
+     */
+    struct Entry
+    {
+        QByteArray name;
+        QByteArray file;
+        QByteArray pattern;
+        QByteArray kind;
+        int line;
+    };
+
+    /**
+     * Get the shared database for a tags file.
+     * @param fileName tags file
+     * @return database, null if the file can't be read
+     */
+    static QSharedPointer<const CTagsDatabase> get(const QString &fileName);
+
+    ~CTagsDatabase();
+
+    /**
+     * Number of entries with the given name or name prefix.
+     * @param name tag name or prefix
+     * @param partial prefix match?
+     * @return entry count
+     */
+    int count(const QByteArray &name, bool partial) const;
+
+    /**
+     * Entries with the given name or name prefix.
+     * @param name tag name or prefix
+     * @param partial prefix match?
+     * @param kinds only return entries of these kinds, all if empty
+     * @return matching entries in tags file order
+     */
+    QVector<Entry> find(const QByteArray &name, bool partial, const QList<QByteArray> &kinds = QList<QByteArray>()) const;
+
+private:
+    explicit CTagsDatabase(const QString &fileName);
+    Q_DISABLE_COPY(CTagsDatabase)
+
+    void buildIndex();
+    const char *lineEnd(quint32 offset) const;
+    int nameLength(quint32 offset) const;
+    int compareName(quint32 offset, const char *name, int length) const;
+    QVector<quint32>::const_iterator lowerBound(const QByteArray &name) const;
+    bool matches(quint32 offset, const QByteArray &name, bool partial) const;
+    Entry entryAt(quint32 offset) const;
+
+private:
+    /**
+     * mapped tags file, stays open while mapped
+     */
+    QFile m_file;
+    const char *m_data;
+    qint64 m_size;
+
+    /**
+     * file state at load time, to detect changes
+     */
+    QDateTime m_modified;
+
+    /**
+     * start offsets of all entries, sorted by name
+     */
+    QVector<quint32> m_index;
+};
+
+#endif
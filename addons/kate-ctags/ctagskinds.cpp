@@ -13,6 +13,9 @@
 
 #include <klocalizedstring.h>
 
+#include <QHash>
+#include <QVector>
+
 struct CTagsKindMapping {
     char abbrev;
     const char *verbose;
@@ -272,18 +275,42 @@ static CTagsExtensionMapping extensionMapping[] = {
 };
 
 
-static CTagsKindMapping *findKindMapping(const QString &extension)
+namespace
 {
-    const char *pextension = extension.toLocal8Bit().constData();
-
-    CTagsExtensionMapping *pem = extensionMapping;
-    while (pem->extension != 0) {
-        if (strcmp(pem->extension, pextension) == 0)
-            return pem->kinds;
-        ++pem;
+/**
+ * extension => kind character => translated kind, languages share their tables
+ */
+struct CTagsKindTables
+{
+    CTagsKindTables()
+    {
+        QHash<const CTagsKindMapping *, int> tableOfMapping;
+        for (const CTagsExtensionMapping *pem = extensionMapping; pem->extension != 0; ++pem) {
+            int table = tableOfMapping.value(pem->kinds, -1);
+            if (table < 0) {
+                table = tables.size();
+                tableOfMapping.insert(pem->kinds, table);
+                tables.append(QVector<QString>(256));
+                for (const CTagsKindMapping *pkm = pem->kinds; pkm->verbose != 0; ++pkm) {
+                    tables.last()[uchar(pkm->abbrev)] = i18nc("Tag Type", pkm->verbose);
+                }
+            }
+            extensions.insert(QByteArray(pem->extension), table);
+        }
     }
 
-    return 0;
+    QVector<QVector<QString> > tables;
+    QHash<QByteArray, int> extensions;
+};
+
+Q_GLOBAL_STATIC(CTagsKindTables, s_kindTables)
+}
+
+
+const QString *CTagsKinds::kindTable( const QByteArray &extension )
+{
+    const int table = s_kindTables->extensions.value(extension, -1);
+    return (table < 0) ? 0 : s_kindTables->tables.at(table).constData();
 }
 
 
@@ -291,15 +318,6 @@ QString CTagsKinds::findKind( const char * kindChar, const QString &extension )
 {
     if ( kindChar == 0 ) return QString();
 
-    CTagsKindMapping *kindMapping = findKindMapping(extension);
-    if (kindMapping) {
-        CTagsKindMapping *pkm = kindMapping;
-        while (pkm->verbose != 0) {
-            if (pkm->abbrev == *kindChar)
-                return i18nc("Tag Type", pkm->verbose);
-            ++pkm;
-        }
-    }
-
-    return QString();
+    const QString *table = kindTable(extension.toLocal8Bit());
+    return table ? table[uchar(*kindChar)] : QString();
 }
@@ -13,12 +13,20 @@
 #define CTAGSKINDS_H
 
 #include <qstring.h>
+#include <qbytearray.h>
 
 
 class CTagsKinds
 {
 public:
     static QString findKind( const char * kindChar, const QString &extension);
+
+    /**
+     * Translated kind names for files with the given extension,
+     * indexed by the kind character. Built once on first use.
+     * @return table with 256 entries, 0 for unknown extensions
+     */
+    static const QString *kindTable( const QByteArray &extension );
 };
 
 #endif
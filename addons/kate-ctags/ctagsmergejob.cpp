@@ -0,0 +1,141 @@
+/* Description : Kate CTags plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ctagsmergejob.h"
+
+#include <QFile>
+#include <QList>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+inline bool isPseudoTag(const QByteArray &line)
+{
+    return line.startsWith("!_");
+}
+
+inline QByteArray tagName(const QByteArray &line)
+{
+    const int tab = line.indexOf('\t');
+    return (tab < 0) ? line : line.left(tab);
+}
+
+inline QByteArray tagFile(const QByteArray &line)
+{
+    const int start = line.indexOf('\t') + 1;
+    const int end = start ? line.indexOf('\t', start) : -1;
+    return (end < 0) ? QByteArray() : line.mid(start, end - start);
+}
+
+/**
+ * same order as ctags sorting: byte wise by tag name
+ */
+inline bool nameLess(const QByteArray &a, const QByteArray &b)
+{
+    return tagName(a) < tagName(b);
+}
+}
+
+/******************************************************************/
+CTagsMergeJob::CTagsMergeJob(const QString &tagsFile, const QString &newTagsFile, const QSet<QString> &files)
+: QObject()
+, QRunnable()
+, m_tagsFile(tagsFile)
+, m_newTagsFile(newTagsFile)
+, m_files(files)
+{
+}
+
+/******************************************************************/
+void CTagsMergeJob::run()
+{
+    const bool success = merge();
+    QFile::remove(m_newTagsFile);
+    emit done(success);
+}
+
+/******************************************************************/
+bool CTagsMergeJob::merge()
+{
+    // the new tags are few, sort them in memory
+    QFile newTags(m_newTagsFile);
+    if (!newTags.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QList<QByteArray> added;
+    while (!newTags.atEnd()) {
+        QByteArray line = newTags.readLine();
+        if (!line.endsWith('\n')) {
+            line.append('\n');
+        }
+        if (line.size() > 1 && !isPseudoTag(line)) {
+            added.append(line);
+        }
+    }
+    std::stable_sort(added.begin(), added.end(), nameLess);
+
+    QSet<QByteArray> files;
+    foreach (const QString &file, m_files) {
+        files.insert(file.toLocal8Bit());
+    }
+
+    // stream the old tags, drop the re-tagged files, merge the new tags in
+    QFile oldTags(m_tagsFile);
+    if (!oldTags.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QSaveFile result(m_tagsFile);
+    if (!result.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QList<QByteArray>::const_iterator next = added.constBegin();
+    while (!oldTags.atEnd()) {
+        QByteArray line = oldTags.readLine();
+        if (!line.endsWith('\n')) {
+            line.append('\n');
+        }
+
+        if (isPseudoTag(line)) {
+            result.write(line);
+            continue;
+        }
+
+        if (files.contains(tagFile(line))) {
+            continue;
+        }
+
+        while (next != added.constEnd() && nameLess(*next, line)) {
+            result.write(*next++);
+        }
+        result.write(line);
+    }
+
+    while (next != added.constEnd()) {
+        result.write(*next++);
+    }
+
+    // atomic rename over the old file
+    return result.commit();
+}
@@ -0,0 +1,67 @@
+/* Description : Kate CTags plugin
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CTAGS_MERGE_JOB_H
+#define CTAGS_MERGE_JOB_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
+#include <QString>
+
+/**
+ * Splices freshly generated tags of some files into a sorted tags file.
+ *
+ * All entries of the re-tagged files are dropped from the old file, the new
+ * entries are merged in while streaming through it. The result replaces the
+ * old file atomically, readers still mapping it are not disturbed.
+ * Runs on the thread pool, done() is emitted when finished.
+ */
+class CTagsMergeJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct merge job.
+     * @param tagsFile tags file to update
+     * @param newTagsFile tags of the re-tagged files, removed when done
+     * @param files re-tagged files, as ctags writes them into the tags file
+     */
+    CTagsMergeJob(const QString &tagsFile, const QString &newTagsFile, const QSet<QString> &files);
+
+    void run();
+
+Q_SIGNALS:
+    /**
+     * Merge finished.
+     * @param success was the tags file updated?
+     */
+    void done(bool success);
+
+private:
+    bool merge();
+
+private:
+    const QString m_tagsFile;
+    const QString m_newTagsFile;
+    const QSet<QString> m_files;
+};
+
+#endif
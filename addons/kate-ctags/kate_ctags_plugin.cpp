@@ -68,6 +68,42 @@ void KateCTagsPlugin::readConfig()
 {
 }
 
+/******************************************************************/
+void KateCTagsPlugin::addSavedFile(const QString &tagsFile, const QString &file)
+{
+    m_savedFiles[tagsFile].insert(file);
+}
+
+/******************************************************************/
+bool KateCTagsPlugin::hasSavedFiles(const QString &tagsFile) const
+{
+    return m_savedFiles.contains(tagsFile);
+}
+
+/******************************************************************/
+QSet<QString> KateCTagsPlugin::takeSavedFiles(const QString &tagsFile)
+{
+    return m_savedFiles.take(tagsFile);
+}
+
+/******************************************************************/
+bool KateCTagsPlugin::lockTagsFile(const QString &tagsFile)
+{
+    if (m_lockedTagsFiles.contains(tagsFile)) {
+        return false;
+    }
+    m_lockedTagsFiles.insert(tagsFile);
+    return true;
+}
+
+/******************************************************************/
+void KateCTagsPlugin::unlockTagsFile(const QString &tagsFile)
+{
+    if (m_lockedTagsFiles.remove(tagsFile) && hasSavedFiles(tagsFile)) {
+        emit tagsFileUnlocked(tagsFile);
+    }
+}
+
 
 
 
@@ -228,7 +264,8 @@ void KateCTagsConfigPage::updateGlobalDB()
         return;
     }
 
-    QString command = QStringLiteral("%1 -f %2 %3").arg(m_confUi.cmdEdit->text()).arg(file).arg(targets) ;
+    // write to a temporary file, the old database might still be mapped
+    QString command = QStringLiteral("%1 -f %2 %3").arg(ctagsCommand(m_confUi.cmdEdit->text())).arg(file + QLatin1String(".tmp")).arg(targets) ;
     m_proc.start(command);
 
     if(!m_proc.waitForStarted(500)) {
@@ -248,6 +285,14 @@ void KateCTagsConfigPage::updateDone(int exitCode, QProcess::ExitStatus status)
     else if (exitCode != 0) {
         KMessageBox::error(this, i18n("The CTags command exited with code %1", exitCode));
     }
+
+    // replace the database, readers see either the old or the new file
+    const QString file = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + QLatin1String("/katectags/common_db");
+    if (status == QProcess::NormalExit && exitCode == 0) {
+        Tags::replaceTagsFile(file + QLatin1String(".tmp"), file);
+    } else {
+        QFile::remove(file + QLatin1String(".tmp"));
+    }
     
     m_confUi.updateDB->setDisabled(false);
     QApplication::restoreOverrideCursor();
@@ -30,6 +30,9 @@
 #include <KTextEditor/ConfigPage>
 #include <KTextEditor/Plugin>
 
+#include <QHash>
+#include <QSet>
+
 #include "kate_ctags_view.h"
 #include "ui_CTagsGlobalConfig.h"
 
@@ -47,8 +50,35 @@ class KateCTagsPlugin : public KTextEditor::Plugin
         int configPages() const { return 1; };
         KTextEditor::ConfigPage *configPage (int number = 0, QWidget *parent = 0);
         void readConfig();
-        
+
+        /**
+         * Incremental update of the session databases, shared by all views:
+         * saved files are collected per tags file and only one view at a time
+         * re-tags a tags file, other windows showing the same session don't
+         * start duplicate ctags runs and merges.
+         */
+        void addSavedFile(const QString &tagsFile, const QString &file);
+        bool hasSavedFiles(const QString &tagsFile) const;
+        QSet<QString> takeSavedFiles(const QString &tagsFile);
+
+        /**
+         * Reserve a tags file for an incremental update.
+         * @return false if another view is updating it
+         */
+        bool lockTagsFile(const QString &tagsFile);
+        void unlockTagsFile(const QString &tagsFile);
+
         KateCTagsView *m_view;
+
+    Q_SIGNALS:
+        /**
+         * An update of the tags file finished, files saved meanwhile are waiting.
+         */
+        void tagsFileUnlocked(const QString &tagsFile);
+
+    private:
+        QHash<QString, QSet<QString> > m_savedFiles;
+        QSet<QString>                  m_lockedTagsFiles;
 };
 
 //******************************************************************/
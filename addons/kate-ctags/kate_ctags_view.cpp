@@ -20,14 +20,18 @@
  */
 
 #include "kate_ctags_view.h"
+#include "kate_ctags_plugin.h"
+#include "ctagsmergejob.h"
 
 #include <QFileInfo>
 #include <QFileDialog>
 #include <QKeyEvent>
+#include <QThreadPool>
 
 #include <KXMLGUIFactory>
 #include <KActionCollection>
 #include <KConfigGroup>
+#include <KTextEditor/Editor>
 #include <QMenu>
 
 #include <klocalizedstring.h>
@@ -36,9 +40,11 @@
 #include <QStandardPaths>
 
 /******************************************************************/
-KateCTagsView::KateCTagsView(KTextEditor::Plugin *plugin, KTextEditor::MainWindow *mainWin)
+KateCTagsView::KateCTagsView(KateCTagsPlugin *plugin, KTextEditor::MainWindow *mainWin)
 : QObject(mainWin)
+, m_plugin(plugin)
 , m_proc(0)
+, m_mergeRunning(false)
 {
     KXMLGUIClient::setComponentName (QLatin1String("katectags"), i18n ("Kate CTag"));
     setXMLFile( QLatin1String("ui.rc") );
@@ -120,12 +126,44 @@ KateCTagsView::KateCTagsView(KTextEditor::Plugin *plugin, KTextEditor::MainWindo
     m_mWin->guiFactory()->addClient(this);
 
     m_commonDB = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + QLatin1String("/katectags/common_db");
+
+    // re-tag saved files, a burst of saves is handled at once
+    m_retagTimer.setSingleShot(true);
+    m_retagTimer.setInterval(1000);
+    connect(&m_retagTimer, SIGNAL(timeout()), this, SLOT(retagSavedFiles()));
+    connect(&m_retagProc, SIGNAL(finished(int,QProcess::ExitStatus)),
+            this, SLOT(retagDone(int,QProcess::ExitStatus)));
+    connect(m_plugin, SIGNAL(tagsFileUnlocked(QString)), this, SLOT(tagsFileUnlocked(QString)));
+
+    KTextEditor::Application *app = KTextEditor::Editor::instance()->application();
+    connect(app, SIGNAL(documentCreated(KTextEditor::Document*)), this, SLOT(documentCreated(KTextEditor::Document*)));
+    foreach (KTextEditor::Document *doc, app->documents()) {
+        documentCreated(doc);
+    }
 }
 
 
 /******************************************************************/
 KateCTagsView::~KateCTagsView()
 {
+    // give up a running update, the merge job releases the tags file itself
+    m_plugin->disconnect(this);
+    if (m_retagProc.state() != QProcess::NotRunning) {
+        m_retagProc.disconnect(this);
+        m_retagProc.kill();
+        m_retagProc.waitForFinished();
+        QFile::remove(m_lockedTagsFile + QLatin1String(".new"));
+        m_plugin->unlockTagsFile(m_lockedTagsFile);
+    }
+    if (m_proc.state() != QProcess::NotRunning) {
+        m_proc.disconnect(this);
+        m_proc.kill();
+        m_proc.waitForFinished();
+        QFile::remove(m_lockedTagsFile + QLatin1String(".tmp"));
+        m_plugin->unlockTagsFile(m_lockedTagsFile);
+        QApplication::restoreOverrideCursor();
+    }
+
     m_mWin->guiFactory()->removeClient( this );
 
     delete m_toolView;
@@ -287,11 +325,11 @@ void KateCTagsView::gotoTagForTypes(const QString &word, const QStringList &type
 
     if (list.count() == 1) {
         Tags::TagEntry tag = list.first();
-        jumpToTag(tag.file, tag.pattern, word);
+        jumpToTag(tag.file, tag.pattern, tag.line, word);
     }
     else {
         Tags::TagEntry tag = list.first();
-        jumpToTag(tag.file, tag.pattern, word);
+        jumpToTag(tag.file, tag.pattern, tag.line, word);
         m_ctagsUi.tabWidget->setCurrentIndex(0);
         m_mWin->showToolView(m_toolView);
     }
@@ -321,6 +359,7 @@ void KateCTagsView::displayHits(const Tags::TagList &list)
         item->setText(1, list[i].type);
         item->setText(2, list[i].file);
         item->setData(0, Qt::UserRole, list[i].pattern);
+        item->setData(1, Qt::UserRole, list[i].line);
 
         QString pattern = list[i].pattern;
         pattern.replace( QStringLiteral("\\/"), QStringLiteral("/"));
@@ -340,9 +379,10 @@ void KateCTagsView::tagHitClicked(QTreeWidgetItem *item)
     // get stuff
     const QString file = item->data(2, Qt::DisplayRole).toString();
     const QString pattern = item->data(0, Qt::UserRole).toString();
+    const int line = item->data(1, Qt::UserRole).toInt();
     const QString word = item->data(0, Qt::DisplayRole).toString();
 
-    jumpToTag(file, pattern, word);
+    jumpToTag(file, pattern, line, word);
 }
 
 /******************************************************************/
@@ -403,11 +443,10 @@ QString KateCTagsView::currentWord( )
 }
 
 /******************************************************************/
-void KateCTagsView::jumpToTag(const QString &file, const QString &pattern, const QString &word)
+void KateCTagsView::jumpToTag(const QString &file, const QString &pattern, int line, const QString &word)
 {
-    if (pattern.isEmpty()) return;
+    if (pattern.isEmpty() && line <= 0) return;
 
-    // generate a regexp from the pattern
     // ctags interestingly escapes "/", but apparently nothing else. lets revert that
     QString unescaped = pattern;
     unescaped.replace( QStringLiteral("\\/"), QStringLiteral("/") );
@@ -416,23 +455,17 @@ void KateCTagsView::jumpToTag(const QString &file, const QString &pattern, const
     // but this isn't true for some macro definitions
     // where the form is only /^foo/
     // I have no idea if this is a ctags bug or not, but we have to deal with it
-
+    // the pattern text is literal, a plain line number as address has no pattern at all
     QString reduced;
-    QString escaped;
-    QString re_string;
-
-    if (unescaped.endsWith(QStringLiteral("$/"))) {
-        reduced = unescaped.mid(2, unescaped.length() - 4);
-        escaped = QRegExp::escape(reduced);
-        re_string = QStringLiteral("^%1$").arg(escaped);
-    }
-    else {
-        reduced = unescaped.mid( 2, unescaped.length() -3 );
-        escaped = QRegExp::escape(reduced);
-        re_string = QStringLiteral("^%1").arg(escaped);
+    bool wholeLine = false;
+    if (unescaped.startsWith(QStringLiteral("/^")) || unescaped.startsWith(QStringLiteral("?^"))) {
+        wholeLine = unescaped.endsWith(QStringLiteral("$/")) || unescaped.endsWith(QStringLiteral("$?"));
+        reduced = unescaped.mid(2, unescaped.length() - (wholeLine ? 4 : 3));
     }
 
-    QRegExp re(re_string);
+    auto lineMatches = [&reduced, wholeLine](const QString &linestr) {
+        return wholeLine ? (linestr == reduced) : linestr.startsWith(reduced);
+    };
 
     // save current location
     TagJump from;
@@ -450,19 +483,43 @@ void KateCTagsView::jumpToTag(const QString &file, const QString &pattern, const
         return;
     }
 
-    // look for the line
-    QString linestr;
-    int line;
-    for (line =0; line < m_mWin->activeView()->document()->lines(); line++) {
-        linestr = m_mWin->activeView()->document()->line(line);
-        if (linestr.indexOf(re) > -1) break;
+    KTextEditor::Document *doc = m_mWin->activeView()->document();
+    const int lines = doc->lines();
+    int found = -1;
+
+    // try the recorded line first, the file might have been edited since tagging,
+    // so look around it, nearest lines first
+    static const int SearchWindow = 32;
+    if (line > 0) {
+        if (reduced.isEmpty()) {
+            found = qMin(line, lines) - 1;
+        } else {
+            for (int delta = 0; delta <= SearchWindow && found < 0; ++delta) {
+                if (line - 1 + delta < lines && lineMatches(doc->line(line - 1 + delta))) {
+                    found = line - 1 + delta;
+                } else if (delta > 0 && line - 1 - delta >= 0 && line - 1 - delta < lines && lineMatches(doc->line(line - 1 - delta))) {
+                    found = line - 1 - delta;
+                }
+            }
+        }
+    }
+
+    // fall back to scanning the whole document
+    if (found < 0 && !reduced.isEmpty()) {
+        for (int l = 0; l < lines; l++) {
+            if (lineMatches(doc->line(l))) {
+                found = l;
+                break;
+            }
+        }
     }
 
     // activate the line
-    if (line != m_mWin->activeView()->document()->lines()) {
+    if (found >= 0) {
         // line found now look for the column
-        int column = linestr.indexOf(word) + (word.length()/2);
-        m_mWin->activeView()->setCursorPosition(KTextEditor::Cursor(line, column));
+        const QString linestr = doc->line(found);
+        int column = qMax(linestr.indexOf(word), 0) + (word.length()/2);
+        m_mWin->activeView()->setCursorPosition(KTextEditor::Cursor(found, column));
     }
     m_mWin->activeView()->setFocus();
 
@@ -481,7 +538,8 @@ void KateCTagsView::startEditTmr()
 /******************************************************************/
 void KateCTagsView::updateSessionDB()
 {
-    if (m_proc.state() != QProcess::NotRunning) {
+    // a running incremental update would overwrite the new database
+    if (m_proc.state() != QProcess::NotRunning || m_retagProc.state() != QProcess::NotRunning || m_mergeRunning) {
         return;
     }
 
@@ -505,19 +563,32 @@ void KateCTagsView::updateSessionDB()
         m_ctagsUi.tagsFile->setText(pluginFolder);
     }
 
+    // another window updates the same database, its merge would overwrite ours
+    const QString tagsFile = m_ctagsUi.tagsFile->text();
+    if (!m_plugin->lockTagsFile(tagsFile)) {
+        return;
+    }
+    m_lockedTagsFile = tagsFile;
+
+    // the full update covers the saved files
+    m_plugin->takeSavedFiles(tagsFile);
+
     if (targets.isEmpty()) {
         KMessageBox::error(0, i18n("No folders or files to index"));
-        QFile::remove(m_ctagsUi.tagsFile->text());
+        QFile::remove(tagsFile);
+        m_plugin->unlockTagsFile(tagsFile);
         return;
     }
 
 
-    QString command = QStringLiteral("%1 -f %2 %3").arg(m_ctagsUi.cmdEdit->text()).arg(m_ctagsUi.tagsFile->text()).arg(targets);
+    // write to a temporary file, the old database might still be mapped
+    QString command = QStringLiteral("%1 -f %2 %3").arg(ctagsCommand(m_ctagsUi.cmdEdit->text())).arg(tagsFile + QLatin1String(".tmp")).arg(targets);
 
     m_proc.start(command);
 
     if(!m_proc.waitForStarted(500)) {
         KMessageBox::error(0, i18n("Failed to run \"%1\". exitStatus = %2", command, m_proc.exitStatus()));
+        m_plugin->unlockTagsFile(tagsFile);
         return;
     }
     QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
@@ -537,11 +608,123 @@ void KateCTagsView::updateDone(int exitCode, QProcess::ExitStatus status)
         , QString::fromLocal8Bit(m_proc.readAllStandardError())));
     }
 
+    // replace the database, readers see either the old or the new file
+    const QString tagsFile = m_lockedTagsFile;
+    if (status == QProcess::NormalExit && exitCode == 0) {
+        Tags::replaceTagsFile(tagsFile + QLatin1String(".tmp"), tagsFile);
+    } else {
+        QFile::remove(tagsFile + QLatin1String(".tmp"));
+    }
+    m_plugin->unlockTagsFile(tagsFile);
+
     m_ctagsUi.updateButton->setDisabled(false);
     m_ctagsUi.updateButton2->setDisabled(false);
     QApplication::restoreOverrideCursor();
 }
 
+/******************************************************************/
+void KateCTagsView::documentCreated(KTextEditor::Document *doc)
+{
+    connect(doc, SIGNAL(documentSavedOrUploaded(KTextEditor::Document*,bool)), this, SLOT(documentSaved(KTextEditor::Document*)));
+}
+
+/******************************************************************/
+void KateCTagsView::documentSaved(KTextEditor::Document *doc)
+{
+    if (!doc->url().isLocalFile() || !QFileInfo(m_ctagsUi.tagsFile->text()).isFile()) {
+        return;
+    }
+
+    // only files inside the indexed folders belong into the session database
+    const QString file = doc->url().toLocalFile();
+    for (int i=0; i<m_ctagsUi.targetList->count(); i++) {
+        QString target = m_ctagsUi.targetList->item(i)->text();
+        if (!target.endsWith(QLatin1Char('/'))) {
+            target += QLatin1Char('/');
+        }
+        if (file.startsWith(target)) {
+            m_plugin->addSavedFile(m_ctagsUi.tagsFile->text(), file);
+            m_retagTimer.start();
+            return;
+        }
+    }
+}
+
+/******************************************************************/
+void KateCTagsView::retagSavedFiles()
+{
+    const QString tagsFile = m_ctagsUi.tagsFile->text();
+    if (!m_plugin->hasSavedFiles(tagsFile)) {
+        return;
+    }
+
+    // one update at a time, try again later
+    if (m_proc.state() != QProcess::NotRunning || m_retagProc.state() != QProcess::NotRunning || m_mergeRunning) {
+        m_retagTimer.start();
+        return;
+    }
+
+    // another window updates the same database, it picks up the files when done
+    if (!m_plugin->lockTagsFile(tagsFile)) {
+        return;
+    }
+
+    m_lockedTagsFile = tagsFile;
+    m_retaggedFiles = m_plugin->takeSavedFiles(tagsFile);
+
+    QString files;
+    foreach (const QString &file, m_retaggedFiles) {
+        files += QLatin1Char('"') + file + QLatin1String("\" ");
+    }
+
+    const QString command = QStringLiteral("%1 -f %2 %3").arg(ctagsCommand(m_ctagsUi.cmdEdit->text())).arg(tagsFile + QLatin1String(".new")).arg(files);
+    m_retagProc.start(command);
+    if (!m_retagProc.waitForStarted(500)) {
+        m_retaggedFiles.clear();
+        m_plugin->unlockTagsFile(tagsFile);
+    }
+}
+
+/******************************************************************/
+void KateCTagsView::retagDone(int exitCode, QProcess::ExitStatus status)
+{
+    const QString tagsFile = m_lockedTagsFile;
+    if (status != QProcess::NormalExit || exitCode != 0) {
+        // silently give up, the user can still regenerate the whole database
+        QFile::remove(tagsFile + QLatin1String(".new"));
+        m_retaggedFiles.clear();
+        m_plugin->unlockTagsFile(tagsFile);
+        return;
+    }
+
+    // splice the new tags into the database in the background
+    // the plugin releases the tags file, this view might be gone by then
+    CTagsMergeJob *job = new CTagsMergeJob(tagsFile, tagsFile + QLatin1String(".new"), m_retaggedFiles);
+    connect(job, SIGNAL(done(bool)), this, SLOT(mergeDone(bool)), Qt::QueuedConnection);
+    KateCTagsPlugin *plugin = m_plugin;
+    connect(job, &CTagsMergeJob::done, m_plugin, [plugin, tagsFile]() {
+        plugin->unlockTagsFile(tagsFile);
+    }, Qt::QueuedConnection);
+    m_mergeRunning = true;
+    QThreadPool::globalInstance()->start(job);
+}
+
+/******************************************************************/
+void KateCTagsView::mergeDone(bool)
+{
+    m_mergeRunning = false;
+    m_retaggedFiles.clear();
+}
+
+/******************************************************************/
+void KateCTagsView::tagsFileUnlocked(const QString &tagsFile)
+{
+    // files saved meanwhile, in this or another window
+    if (tagsFile == m_ctagsUi.tagsFile->text()) {
+        m_retagTimer.start();
+    }
+}
+
 /******************************************************************/
 void KateCTagsView::addTagTarget()
 {
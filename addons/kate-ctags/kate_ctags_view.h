@@ -32,16 +32,33 @@
 #include <QProcess>
 #include <KXMLGUIClient>
 
+#include <QSet>
 #include <QStack>
 #include <QTimer>
 #include <KActionMenu>
 #include <QPointer>
+#include <QRegularExpression>
 
 #include "tags.h"
 
 #include "ui_kate_ctags.h"
 
-const static QString DEFAULT_CTAGS_CMD = QLatin1String("ctags -R --c++-types=+px --extra=+q --excmd=pattern --exclude=Makefile --exclude=.");
+const static QString DEFAULT_CTAGS_CMD = QLatin1String("ctags -R --c++-types=+px --extra=+q --fields=+n --excmd=pattern --exclude=Makefile --exclude=.");
+
+/**
+ * The configured ctags command, with line numbers requested unless the
+ * command says otherwise: commands stored before --fields=+n became the
+ * default lack it, without line numbers every jump searches the file.
+ */
+inline QString ctagsCommand(const QString &command)
+{
+    if (command.contains(QRegularExpression(QStringLiteral("--fields=\\S*n")))) {
+        return command;
+    }
+    return command + QLatin1String(" --fields=+n");
+}
+
+class KateCTagsPlugin;
 
 typedef struct
 {
@@ -56,7 +73,7 @@ class KateCTagsView : public QObject, public KXMLGUIClient, public KTextEditor::
     Q_INTERFACES(KTextEditor::SessionConfigInterface)
 
 public:
-  KateCTagsView(KTextEditor::Plugin *plugin, KTextEditor::MainWindow *mainWin);
+  KateCTagsView(KateCTagsPlugin *plugin, KTextEditor::MainWindow *mainWin);
     ~KateCTagsView();
 
     // reimplemented: read and write session config
@@ -79,6 +96,14 @@ public Q_SLOTS:
     void updateSessionDB();
     void updateDone(int exitCode, QProcess::ExitStatus status);
 
+private Q_SLOTS:
+    void documentCreated(KTextEditor::Document *doc);
+    void documentSaved(KTextEditor::Document *doc);
+    void retagSavedFiles();
+    void retagDone(int exitCode, QProcess::ExitStatus status);
+    void mergeDone(bool success);
+    void tagsFileUnlocked(const QString &tagsFile);
+
 protected:
     bool eventFilter(QObject *obj, QEvent *ev);
 
@@ -95,9 +120,10 @@ private:
     void displayHits(const Tags::TagList &list);
     
     void gotoTagForTypes(const QString &tag, QStringList const &types);
-    void jumpToTag(const QString &file, const QString &pattern, const QString &word);
+    void jumpToTag(const QString &file, const QString &pattern, int line, const QString &word);
     
 
+    KateCTagsPlugin       *m_plugin;
     KTextEditor::MainWindow *m_mWin;
     QWidget               *m_toolView;
     Ui::kateCtags          m_ctagsUi;
@@ -112,6 +138,14 @@ private:
 
     QTimer                 m_editTimer;
     QStack<TagJump>        m_jumpStack;
+
+    // incremental update of the session database on save, saved files are collected by the plugin
+    // m_lockedTagsFile is the database this view updates, incrementally or fully
+    QProcess               m_retagProc;
+    QTimer                 m_retagTimer;
+    QString                m_lockedTagsFile;
+    QSet<QString>          m_retaggedFiles;
+    bool                   m_mergeRunning;
 };
 
 
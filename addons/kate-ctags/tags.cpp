@@ -9,74 +9,60 @@
  *                                                                         *
  ***************************************************************************/
 #include "tags.h"
-#include <stdio.h>
-
-namespace ctags
-{
-#include "readtags.h"
-}
+#include "ctagsdatabase.h"
 
 #include "ctagskinds.h"
 
+#include <QFile>
+#include <QHash>
+
+#include <cstdio>
+
 QString Tags::_tagsfile;
 
-Tags::TagEntry::TagEntry() {}
+Tags::TagEntry::TagEntry() : line(0) {}
 
-Tags::TagEntry::TagEntry( const QString & tag, const QString & type, const QString & file, const QString & pattern )
-	: tag(tag), type(type), file(file), pattern(pattern)
+Tags::TagEntry::TagEntry( const QString & tag, const QString & type, const QString & file, const QString & pattern, int line )
+	: tag(tag), type(type), file(file), pattern(pattern), line(line)
 {}
 
 
-bool Tags::hasTag( const QString & tag )
+bool Tags::replaceTagsFile( const QString & newFile, const QString & tagsFile )
 {
-	ctags::tagFileInfo info;
-	ctags::tagFile * file = ctags::tagsOpen( _tagsfile.toLocal8Bit().constData(), &info );
-	ctags::tagEntry entry;
+#ifdef Q_OS_WIN
+	// no atomic replace of an existing file there
+	QFile::remove( tagsFile );
+#endif
 
-	bool found = ( ctags::tagsFind( file, &entry, tag.toLocal8Bit().constData(), TAG_FULLMATCH | TAG_OBSERVECASE ) == ctags::TagSuccess );
+	// rename over the old file is atomic on POSIX
+	if ( std::rename( QFile::encodeName( newFile ).constData(), QFile::encodeName( tagsFile ).constData() ) == 0 )
+		return true;
+
+	QFile::remove( newFile );
+	return false;
+}
 
-	ctags::tagsClose( file );
+bool Tags::hasTag( const QString & tag )
+{
+	QSharedPointer<const CTagsDatabase> database = CTagsDatabase::get( _tagsfile );
 
-	return found;
+	return database && database->count( tag.toLocal8Bit(), false ) > 0;
 }
 
 bool Tags::hasTag( const QString & fileName, const QString & tag )
 {
 	setTagsFile( fileName );
-	ctags::tagFileInfo info;
-	ctags::tagFile * file = ctags::tagsOpen( _tagsfile.toLocal8Bit().constData(), &info );
-	ctags::tagEntry entry;
-
-	bool found = ( ctags::tagsFind( file, &entry, tag.toLocal8Bit().constData(), TAG_FULLMATCH | TAG_OBSERVECASE ) == ctags::TagSuccess );
-
-	ctags::tagsClose( file );
-
-	return found;
+	return hasTag( tag );
 }
 
 unsigned int Tags::numberOfMatches( const QString & tagpart, bool partial )
 {
-	unsigned int n = 0;
-
 	if ( tagpart.isEmpty() ) return 0;
 
-	ctags::tagFileInfo info;
-	ctags::tagFile * file = ctags::tagsOpen( _tagsfile.toLocal8Bit().constData(), &info );
-	ctags::tagEntry entry;
-
-	QByteArray tagpartBArray = tagpart.toLocal8Bit(); // for holding the char *
-	if ( ctags::tagsFind( file, &entry, tagpartBArray.data(), TAG_OBSERVECASE | (partial ? TAG_PARTIALMATCH : TAG_FULLMATCH) ) == ctags::TagSuccess )
-	{
-		do
-		{
-			n++;
-		}
-		while ( ctags::tagsFindNext( file, &entry ) == ctags::TagSuccess );
-	}
-
-	ctags::tagsClose( file );
+	QSharedPointer<const CTagsDatabase> database = CTagsDatabase::get( _tagsfile );
+	if ( !database ) return 0;
 
-	return n;
+	return database->count( tagpart.toLocal8Bit(), partial );
 }
 
 Tags::TagList Tags::getMatches( const QString & tagpart, bool partial, const QStringList & types )
@@ -85,31 +71,48 @@ Tags::TagList Tags::getMatches( const QString & tagpart, bool partial, const QSt
 
 	if ( tagpart.isEmpty() ) return list;
 
-	ctags::tagFileInfo info;
-	ctags::tagFile * file = ctags::tagsOpen( _tagsfile.toLocal8Bit().constData(), &info );
-	ctags::tagEntry entry;
+	QSharedPointer<const CTagsDatabase> database = CTagsDatabase::get( _tagsfile );
+	if ( !database ) return list;
+
+	QList<QByteArray> kinds;
+	foreach ( const QString & type, types )
+	{
+		kinds << type.toLocal8Bit();
+	}
+
+	const QVector<CTagsDatabase::Entry> entries = database->find( tagpart.toLocal8Bit(), partial, kinds );
+	list.reserve( entries.size() );
 
-	QByteArray tagpartBArray = tagpart.toLocal8Bit(); // for holding the char *
-	if ( ctags::tagsFind( file, &entry, tagpartBArray.data(), TAG_OBSERVECASE | (partial ? TAG_PARTIALMATCH : TAG_FULLMATCH) ) == ctags::TagSuccess )
+	// many matches share a file: convert each file name and resolve its kind table only once
+	struct FileInfo
 	{
-		do
+		QString name;
+		const QString * kindTable;
+	};
+	QHash<QByteArray, FileInfo> files;
+
+	foreach ( const CTagsDatabase::Entry & entry, entries )
+	{
+		QHash<QByteArray, FileInfo>::iterator fileInfo = files.find( entry.file );
+		if ( fileInfo == files.end() )
 		{
-			QString type( CTagsKinds::findKind( entry.kind, QString::fromLocal8Bit(entry.file).section( QLatin1Char('.') , -1 ) ) );
-			QString file = QString::fromLocal8Bit( entry.file );
-
-			if ( type.isEmpty() && file.endsWith( QLatin1String("Makefile") ) )
-			{
-				type = QLatin1String("macro");
-			}
-			if ( types.isEmpty() || types.contains( QString::fromLocal8Bit(entry.kind) ) )
-			{
-				list << TagEntry( QString::fromLocal8Bit( entry.name ), type, file, QString::fromLocal8Bit( entry.address.pattern ) );
-			}
+			const FileInfo info = { QString::fromLocal8Bit( entry.file ), CTagsKinds::kindTable( entry.file.mid( entry.file.lastIndexOf( '.' ) + 1 ) ) };
+			fileInfo = files.insert( entry.file, info );
 		}
-		while ( ctags::tagsFindNext( file, &entry ) == ctags::TagSuccess );
-	}
+		const QString & file = fileInfo->name;
+		const QString * kindTable = fileInfo->kindTable;
 
-	ctags::tagsClose( file );
+		QString type;
+		if ( kindTable && !entry.kind.isEmpty() )
+		{
+			type = kindTable[ uchar( entry.kind.at( 0 ) ) ];
+		}
+		if ( type.isEmpty() && file.endsWith( QLatin1String("Makefile") ) )
+		{
+			type = QLatin1String("macro");
+		}
+		list << TagEntry( QString::fromLocal8Bit( entry.name ), type, file, QString::fromLocal8Bit( entry.pattern ), entry.line );
+	}
 
 	return list;
 }
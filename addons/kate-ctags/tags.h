@@ -23,12 +23,14 @@ public:
 	struct TagEntry
 	{
 		TagEntry();
-		TagEntry( const QString & tag, const QString & type, const QString & file, const QString & pattern );
+		TagEntry( const QString & tag, const QString & type, const QString & file, const QString & pattern, int line = 0 );
 
 		QString tag;
 		QString type;
 		QString file;
 		QString pattern;
+		int line; // 1-based, 0 if unknown
+
 	};
 
 	typedef QList<TagEntry> TagList;
@@ -61,6 +63,14 @@ public:
 	static TagList getExactMatches( const QString & file, const QString & tag );
 	static TagList getMatches( const QString & file, const QString & tagpart, bool partial, const QStringList & types = QStringList() );
 
+	/**
+	 *    Replace a tag database with a newly generated one, readers see either the old or the new file
+	 * @param newFile the new database, removed if the replace fails
+	 * @param tagsFile the database to replace
+	 * @return true on success, the old database stays on failure
+	 */
+	static bool replaceTagsFile( const QString & newFile, const QString & tagsFile );
+
 private:
 	static QString _tagsfile;
 };
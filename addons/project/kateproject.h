@@ -24,6 +24,7 @@
 #include <QDateTime>
 #include <QMap>
 #include <QSharedPointer>
+#include <QStandardItemModel>
 #include <QTextDocument>
 #include <KTextEditor/ModificationInterface>
 #include "kateprojectindex.h"
@@ -42,6 +43,9 @@ Q_DECLARE_METATYPE(KateProjectSharedQMapStringItem)
 typedef QSharedPointer<KateProjectIndex> KateProjectSharedProjectIndex;
 Q_DECLARE_METATYPE(KateProjectSharedProjectIndex)
 
+typedef QSharedPointer<QVector<KateProjectIndexMatch> > KateProjectSharedIndexMatches;
+Q_DECLARE_METATYPE(KateProjectSharedIndexMatches)
+
 namespace ThreadWeaver {
 class Queue;
 }
@@ -156,6 +160,15 @@ public:
         return m_projectIndex.data();
     }
 
+    /**
+     * Access to project index as shared pointer.
+     * Use this to keep the index alive during background queries.
+     * @return shared project index, may be null
+     */
+    KateProjectSharedProjectIndex sharedProjectIndex() const {
+        return m_projectIndex;
+    }
+
     /**
      * Computes a suitable file name for the given suffix.
      * If you e.g. want to store a "notes" file, you could pass "notes" and get
@@ -24,22 +24,138 @@
 
 #include <klocalizedstring.h>
 
+#include <ThreadWeaver/Queue>
+
 #include <QIcon>
 
 KateProjectCompletion::KateProjectCompletion(KateProjectPlugin *plugin)
     : KTextEditor::CodeCompletionModel(0)
     , m_plugin(plugin)
+    , m_serial(0)
+    , m_automatic(false)
 {
 }
 
 KateProjectCompletion::~KateProjectCompletion()
 {
+    cancelQuery();
 }
 
 void KateProjectCompletion::saveMatches(KTextEditor::View *view, const KTextEditor::Range &range)
 {
+    /**
+     * get project index for this document, else no matches
+     */
+    KateProject *project = m_plugin->projectForDocument(view->document());
+    const KateProjectSharedProjectIndex index = project ? project->sharedProjectIndex() : KateProjectSharedProjectIndex();
+    m_prefix = view->document()->text(range);
+    if (!index || !index->isValid() || m_prefix.isEmpty()) {
+        cancelQuery();
+        clearMatches();
+        return;
+    }
+
+    /**
+     * prefix grew since last finished query => narrow the cached result
+     */
+    if (m_cachedIndex == index && m_prefix.startsWith(m_cachedPrefix)) {
+        cancelQuery();
+        showCachedMatches(m_prefix);
+        return;
+    }
+
+    /**
+     * prefix grew since the running query started => let it finish, we narrow on arrival
+     */
+    if (m_cancel && m_pendingIndex == index && m_prefix.startsWith(m_pendingPrefix)) {
+        return;
+    }
+
+    /**
+     * start new query, old matches are for something else
+     */
+    cancelQuery();
+    clearMatches();
+
+    m_cancel = KateProjectSharedCancelFlag(new QAtomicInt(0));
+    m_pendingIndex = index;
+    m_pendingPrefix = m_prefix;
+
+    KateProjectCompletionJob *job = new KateProjectCompletionJob(++m_serial, index, m_prefix, m_cancel);
+    connect(job, &KateProjectCompletionJob::matchesFound, this, &KateProjectCompletion::slotMatchesFound);
+    m_plugin->queryWeaver()->stream() << job;
+}
+
+void KateProjectCompletion::slotMatchesFound(quint64 serial, const QString &prefix, const QStringList &matches)
+{
+    /**
+     * outdated query, ignore
+     */
+    if (serial != m_serial || !m_cancel) {
+        return;
+    }
+
+    /**
+     * remember result for the next keystrokes
+     */
+    m_cancel.clear();
+    m_cachedIndex = m_pendingIndex;
+    m_cachedPrefix = prefix;
+    m_cachedNames = matches;
+    m_pendingIndex.clear();
+    m_pendingPrefix.clear();
+
+    /**
+     * show everything, narrowed to what the user typed in the meantime
+     */
+    m_shownPrefix.clear();
+    showCachedMatches(m_prefix);
+}
+
+void KateProjectCompletion::showCachedMatches(const QString &prefix)
+{
+    beginResetModel();
+
+    /**
+     * narrowing the shown matches is enough if the prefix just grew
+     */
+    if (!m_shownPrefix.isEmpty() && prefix.startsWith(m_shownPrefix)) {
+        QVector<int> narrowed;
+        for (int id : m_matches) {
+            if (m_cachedNames.at(id).startsWith(prefix)) {
+                narrowed.append(id);
+            }
+        }
+        m_matches.swap(narrowed);
+    } else {
+        m_matches.clear();
+        for (int id = 0; id < m_cachedNames.size(); ++id) {
+            if (m_cachedNames.at(id).startsWith(prefix)) {
+                m_matches.append(id);
+            }
+        }
+    }
+    m_shownPrefix = prefix;
+
+    endResetModel();
+}
+
+void KateProjectCompletion::clearMatches()
+{
+    beginResetModel();
     m_matches.clear();
-    allMatches(m_matches, view, range);
+    m_shownPrefix.clear();
+    endResetModel();
+}
+
+void KateProjectCompletion::cancelQuery()
+{
+    if (m_cancel) {
+        m_cancel->store(1);
+        m_cancel.clear();
+    }
+    m_pendingIndex.clear();
+    m_pendingPrefix.clear();
 }
 
 QVariant KateProjectCompletion::data(const QModelIndex &index, int role) const
@@ -59,7 +175,7 @@ QVariant KateProjectCompletion::data(const QModelIndex &index, int role) const
     }
 
     if (index.column() == KTextEditor::CodeCompletionModel::Name && role == Qt::DisplayRole) {
-        return m_matches.item(index.row())->data(Qt::DisplayRole);
+        return m_cachedNames.at(m_matches.at(index.row()));
     }
 
     if (index.column() == KTextEditor::CodeCompletionModel::Icon && role == Qt::DecorationRole) {
@@ -92,7 +208,7 @@ QModelIndex KateProjectCompletion::index(int row, int column, const QModelIndex
         return QModelIndex();
     }
 
-    if (row < 0 || row >= m_matches.rowCount() || column < 0 || column >= ColumnCount) {
+    if (row < 0 || row >= m_matches.size() || column < 0 || column >= ColumnCount) {
         return QModelIndex();
     }
 
@@ -101,12 +217,12 @@ QModelIndex KateProjectCompletion::index(int row, int column, const QModelIndex
 
 int KateProjectCompletion::rowCount(const QModelIndex &parent) const
 {
-    if (!parent.isValid() && !(m_matches.rowCount() == 0)) {
+    if (!parent.isValid() && !(m_matches.size() == 0)) {
         return 1;    //One root node to define the custom group
     } else if (parent.parent().isValid()) {
         return 0;    //Completion-items have no children
     } else {
-        return m_matches.rowCount();
+        return m_matches.size();
     }
 }
 
@@ -165,7 +281,8 @@ void KateProjectCompletion::completionInvoked(KTextEditor::View *view, const KTe
         if (range.columnWidth() >= 3 /*v->config()->wordCompletionMinimalWordLength()*/) {
             saveMatches(view, range);
         } else {
-            m_matches.clear();
+            cancelQuery();
+            clearMatches();
         }
 
         // done here...
@@ -176,26 +293,6 @@ void KateProjectCompletion::completionInvoked(KTextEditor::View *view, const KTe
     saveMatches(view, range);
 }
 
-// Scan throughout the entire document for possible completions,
-// ignoring any dublets
-void KateProjectCompletion::allMatches(QStandardItemModel &model, KTextEditor::View *view, const KTextEditor::Range &range) const
-{
-    /**
-     * get project for this document, else fail
-     */
-    KateProject *project = m_plugin->projectForDocument(view->document());
-    if (!project) {
-        return;
-    }
-
-    /**
-     * let project index fill the completion for this document
-     */
-    if (project->projectIndex()) {
-        project->projectIndex()->findMatches(model, view->document()->text(range), KateProjectIndex::CompletionMatches);
-    }
-}
-
 KTextEditor::CodeCompletionModelControllerInterface::MatchReaction KateProjectCompletion::matchingItem(const QModelIndex & /*matched*/)
 {
     return HideListIfAutomaticInvocation;
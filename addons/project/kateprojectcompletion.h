@@ -26,7 +26,10 @@
 #include <ktexteditor/codecompletionmodel.h>
 #include <ktexteditor/codecompletionmodelcontrollerinterface.h>
 
-#include <QStandardItemModel>
+#include "kateprojectcompletionjob.h"
+
+#include <QVector>
+#include <QWeakPointer>
 
 /**
  * Project wide completion support.
@@ -76,7 +79,32 @@ public:
 
     virtual KTextEditor::Range completionRange(KTextEditor::View *view, const KTextEditor::Cursor &position);
 
-    void allMatches(QStandardItemModel &model, KTextEditor::View *view, const KTextEditor::Range &range) const;
+private Q_SLOTS:
+    /**
+     * Results of a background query arrived.
+     * @param serial query serial, outdated results are ignored
+     * @param prefix prefix the matches belong to
+     * @param matches matching names
+     */
+    void slotMatchesFound(quint64 serial, const QString &prefix, const QStringList &matches);
+
+private:
+    /**
+     * Show the cached matches that start with the given prefix.
+     * Narrows the current matches if the prefix extends the displayed one.
+     * @param prefix prefix to filter for
+     */
+    void showCachedMatches(const QString &prefix);
+
+    /**
+     * Drop the displayed matches.
+     */
+    void clearMatches();
+
+    /**
+     * Abort the running query, if any.
+     */
+    void cancelQuery();
 
 private:
     /**
@@ -85,9 +113,42 @@ private:
     KateProjectPlugin *m_plugin;
 
     /**
-     * model with matching data
+     * serial of the last started query
+     */
+    quint64 m_serial;
+
+    /**
+     * cancel flag of the running query, if any
+     */
+    KateProjectSharedCancelFlag m_cancel;
+
+    /**
+     * index and prefix of the running query
+     */
+    QWeakPointer<KateProjectIndex> m_pendingIndex;
+    QString m_pendingPrefix;
+
+    /**
+     * result of the last finished query, reused while the prefix grows
+     */
+    QWeakPointer<KateProjectIndex> m_cachedIndex;
+    QString m_cachedPrefix;
+    QStringList m_cachedNames;
+
+    /**
+     * prefix the user typed, matches shown are for this one
+     */
+    QString m_prefix;
+
+    /**
+     * prefix the current matches were filtered for, empty if none
+     */
+    QString m_shownPrefix;
+
+    /**
+     * matching data, indices into m_cachedNames
      */
-    QStandardItemModel m_matches;
+    QVector<int> m_matches;
 
     /**
      * automatic invocation?
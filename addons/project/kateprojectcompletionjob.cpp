@@ -0,0 +1,50 @@
+/*  This file is part of the Kate project.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectcompletionjob.h"
+
+KateProjectCompletionJob::KateProjectCompletionJob(quint64 serial, const KateProjectSharedProjectIndex &index, const QString &prefix, const KateProjectSharedCancelFlag &cancel)
+    : QObject()
+    , ThreadWeaver::Job()
+    , m_serial(serial)
+    , m_index(index)
+    , m_prefix(prefix)
+    , m_cancel(cancel)
+{
+}
+
+void KateProjectCompletionJob::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
+{
+    /**
+     * superseded before we even started?
+     */
+    if (m_cancel->load()) {
+        return;
+    }
+
+    const QStringList matches = m_index->completionMatches(m_prefix, m_cancel.data());
+
+    /**
+     * don't report partial results
+     */
+    if (m_cancel->load()) {
+        return;
+    }
+
+    emit matchesFound(m_serial, m_prefix, matches);
+}
@@ -0,0 +1,71 @@
+/*  This file is part of the Kate project.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_COMPLETION_JOB_H
+#define KATE_PROJECT_COMPLETION_JOB_H
+
+#include "kateproject.h"
+
+#include <ThreadWeaver/Job>
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QStringList>
+
+/**
+ * Shared cancel flag, set to non-zero to abort a running query.
+ */
+typedef QSharedPointer<QAtomicInt> KateProjectSharedCancelFlag;
+
+/**
+ * Background job querying the project index for completion matches.
+ * Results are sent back via queued signal, cancelled jobs send nothing.
+ */
+class KateProjectCompletionJob : public QObject, public ThreadWeaver::Job
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct query job.
+     * @param serial query serial, passed back with the results
+     * @param index project index to search, kept alive by the job
+     * @param prefix prefix to search for
+     * @param cancel cancel flag for this query
+     */
+    KateProjectCompletionJob(quint64 serial, const KateProjectSharedProjectIndex &index, const QString &prefix, const KateProjectSharedCancelFlag &cancel);
+
+    void run(ThreadWeaver::JobPointer self, ThreadWeaver::Thread *thread);
+
+Q_SIGNALS:
+    /**
+     * Query done.
+     * @param serial query serial
+     * @param prefix prefix the matches belong to
+     * @param matches matching names
+     */
+    void matchesFound(quint64 serial, const QString &prefix, const QStringList &matches);
+
+private:
+    const quint64 m_serial;
+    const KateProjectSharedProjectIndex m_index;
+    const QString m_prefix;
+    const KateProjectSharedCancelFlag m_cancel;
+};
+
+#endif
@@ -22,6 +22,8 @@
 
 #include <QProcess>
 #include <QDir>
+#include <QMutexLocker>
+#include <QSet>
 
 /**
  * include ctags reading
@@ -125,43 +127,40 @@ void KateProjectIndex::loadCtags(const QStringList &files, const QVariantMap &ct
     m_ctagsIndexHandle = tagsOpen(m_ctagsIndexFile.fileName().toLocal8Bit().constData(), &info);
 }
 
-void KateProjectIndex::findMatches(QStandardItemModel &model, const QString &searchWord, MatchType type)
+QVector<KateProjectIndexMatch> KateProjectIndex::findMatches(const QString &searchWord, int maxMatches, const QAtomicInt *cancel)
 {
     /**
-     * abort if no ctags index
+     * abort if no ctags index or nothing to search
      */
-    if (!m_ctagsIndexHandle) {
-        return;
+    QVector<KateProjectIndexMatch> matches;
+    const QByteArray word = searchWord.toLocal8Bit();
+    if (!m_ctagsIndexHandle || word.isEmpty()) {
+        return matches;
     }
 
     /**
-     * word to complete
-     * abort if empty
+     * handle is shared with other query jobs
      */
-    QByteArray word = searchWord.toLocal8Bit();
-    if (word.isEmpty()) {
-        return;
-    }
+    QMutexLocker locker(&m_ctagsIndexMutex);
 
     /**
      * try to search entry
      * fail if none found
      */
     tagEntry entry;
-    if (tagsFind(m_ctagsIndexHandle, &entry, word.constData(), TAG_PARTIALMATCH  | TAG_OBSERVECASE) != TagSuccess) {
-        return;
+    if (tagsFind(m_ctagsIndexHandle, &entry, word.constData(), TAG_PARTIALMATCH | TAG_OBSERVECASE) != TagSuccess) {
+        return matches;
     }
 
-    /**
-     * set to show words only once for completion matches
-     */
-    QSet<QString> guard;
-
     /**
      * loop over all found tags
      * first one is filled by above find, others by find next
      */
     do {
+        if (cancel && cancel->load()) {
+            return QVector<KateProjectIndexMatch>();
+        }
+
         /**
          * skip if no name
          */
@@ -169,37 +168,54 @@ void KateProjectIndex::findMatches(QStandardItemModel &model, const QString &sea
             continue;
         }
 
-        /**
-         * get name
-         */
-        QString name(QString::fromLocal8Bit(entry.name));
+        KateProjectIndexMatch match;
+        match.name = QString::fromLocal8Bit(entry.name);
+        match.kind = entry.kind ? QString::fromLocal8Bit(entry.kind) : QString();
+        match.file = entry.file ? QString::fromLocal8Bit(entry.file) : QString();
+        match.line = entry.address.lineNumber;
+        matches.append(match);
+    } while (matches.size() < maxMatches && tagsFindNext(m_ctagsIndexHandle, &entry) == TagSuccess);
 
-        /**
-         * construct right items
-         */
-        switch (type) {
-        case CompletionMatches:
-            /**
-             * add new completion item, if new name
-             */
-            if (!guard.contains(name)) {
-                model.appendRow(new QStandardItem(name));
-                guard.insert(name);
-            }
-            break;
-
-        case FindMatches:
-            /**
-             * add new find item, contains of multiple columns
-             */
-            QList<QStandardItem *> items;
-            items << new QStandardItem(name);
-            items << new QStandardItem(entry.kind ? QString::fromLocal8Bit(entry.kind) : QString());
-            items << new QStandardItem(entry.file ? QString::fromLocal8Bit(entry.file) : QString());
-            items << new QStandardItem(QString::number(entry.address.lineNumber));
-            model.appendRow(items);
-            break;
+    return matches;
+}
+
+QStringList KateProjectIndex::completionMatches(const QString &prefix, const QAtomicInt *cancel)
+{
+    /**
+     * abort if no ctags index or nothing to search
+     */
+    const QByteArray word = prefix.toLocal8Bit();
+    if (!m_ctagsIndexHandle || word.isEmpty()) {
+        return QStringList();
+    }
+
+    QMutexLocker locker(&m_ctagsIndexMutex);
+
+    tagEntry entry;
+    if (tagsFind(m_ctagsIndexHandle, &entry, word.constData(), TAG_PARTIALMATCH | TAG_OBSERVECASE) != TagSuccess) {
+        return QStringList();
+    }
+
+    /**
+     * show each name only once
+     */
+    QStringList matches;
+    QSet<QByteArray> guard;
+    do {
+        if (cancel && cancel->load()) {
+            return QStringList();
+        }
+
+        if (!entry.name) {
+            continue;
+        }
+
+        const QByteArray name(entry.name);
+        if (!guard.contains(name)) {
+            guard.insert(name);
+            matches.append(QString::fromLocal8Bit(name));
         }
     } while (tagsFindNext(m_ctagsIndexHandle, &entry) == TagSuccess);
-}
 
+    return matches;
+}
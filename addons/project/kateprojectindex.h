@@ -24,15 +24,27 @@
 #include <ktexteditor/document.h>
 #include <ktexteditor/view.h>
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QStringList>
+#include <QVector>
 #include <QTemporaryFile>
-#include <QStandardItemModel>
 
 /**
  * ctags reading
  */
 #include "ctags/readtags.h"
 
+/**
+ * One match of a find query on the index.
+ */
+struct KateProjectIndexMatch {
+    QString name;
+    QString kind;
+    QString file;
+    int line;
+};
+
 /**
  * Class representing the index of a project.
  * This includes knowledge from ctags and Co.
@@ -56,29 +68,23 @@ public:
     ~KateProjectIndex();
 
     /**
-     * Which kind of match items should be created in the passed model
-     * of the findMatches function?
+     * Find matches for given word, containing name, kind, file, line.
+     * Thread-safe, used by the index view query jobs.
+     * @param searchWord word to search for
+     * @param maxMatches stop after that many matches
+     * @param cancel optional flag, if it becomes non-zero the search is aborted
+     * @return matches in index order, empty if aborted
      */
-    enum MatchType {
-        /**
-         * Completion matches, containing only name and same name only once
-         */
-        CompletionMatches,
-
-        /**
-         * Find matches, containing name, kind, file, line, ...
-         */
-        FindMatches
-    };
+    QVector<KateProjectIndexMatch> findMatches(const QString &searchWord, int maxMatches, const QAtomicInt *cancel = nullptr);
 
     /**
-     * Fill in completion matches for given view/range.
-     * Uses e.g. ctags index.
-     * @param model model to fill with matches
-     * @param searchWord word to search for
-     * @param type type of matches
+     * Collect completion matches for given prefix, each name only once.
+     * Thread-safe, used by the completion worker jobs.
+     * @param prefix prefix to search for
+     * @param cancel optional flag, if it becomes non-zero the search is aborted
+     * @return matching names in index order, empty if aborted
      */
-    void findMatches(QStandardItemModel &model, const QString &searchWord, MatchType type);
+    QStringList completionMatches(const QString &prefix, const QAtomicInt *cancel = nullptr);
 
     /**
      * Check if running ctags was successful. This can be used
@@ -107,6 +113,11 @@ private:
      * handle to ctags file for querying, if possible
      */
     tagFile *m_ctagsIndexHandle;
+
+    /**
+     * ctags handle is stateful, guard queries against concurrent access
+     */
+    QMutex m_ctagsIndexMutex;
 };
 
 #endif
@@ -0,0 +1,51 @@
+/*  This file is part of the Kate project.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectindexqueryjob.h"
+
+KateProjectIndexQueryJob::KateProjectIndexQueryJob(quint64 serial, const KateProjectSharedProjectIndex &index, const QString &searchWord, int maxMatches, const KateProjectSharedCancelFlag &cancel)
+    : QObject()
+    , ThreadWeaver::Job()
+    , m_serial(serial)
+    , m_index(index)
+    , m_searchWord(searchWord)
+    , m_maxMatches(maxMatches)
+    , m_cancel(cancel)
+{
+}
+
+void KateProjectIndexQueryJob::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
+{
+    /**
+     * superseded before we even started?
+     */
+    if (m_cancel->load()) {
+        return;
+    }
+
+    KateProjectSharedIndexMatches matches(new QVector<KateProjectIndexMatch>(m_index->findMatches(m_searchWord, m_maxMatches, m_cancel.data())));
+
+    /**
+     * don't report partial results
+     */
+    if (m_cancel->load()) {
+        return;
+    }
+
+    emit matchesFound(m_serial, matches);
+}
@@ -0,0 +1,61 @@
+/*  This file is part of the Kate project.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_INDEX_QUERY_JOB_H
+#define KATE_PROJECT_INDEX_QUERY_JOB_H
+
+#include "kateprojectcompletionjob.h"
+
+/**
+ * Background job running a find query on the project index.
+ * Results are sent back via queued signal, cancelled jobs send nothing.
+ */
+class KateProjectIndexQueryJob : public QObject, public ThreadWeaver::Job
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct query job.
+     * @param serial query serial, passed back with the results
+     * @param index project index to search, kept alive by the job
+     * @param searchWord word to search for
+     * @param maxMatches stop after that many matches
+     * @param cancel cancel flag for this query
+     */
+    KateProjectIndexQueryJob(quint64 serial, const KateProjectSharedProjectIndex &index, const QString &searchWord, int maxMatches, const KateProjectSharedCancelFlag &cancel);
+
+    void run(ThreadWeaver::JobPointer self, ThreadWeaver::Thread *thread);
+
+Q_SIGNALS:
+    /**
+     * Query done.
+     * @param serial query serial
+     * @param matches found matches
+     */
+    void matchesFound(quint64 serial, KateProjectSharedIndexMatches matches);
+
+private:
+    const quint64 m_serial;
+    const KateProjectSharedProjectIndex m_index;
+    const QString m_searchWord;
+    const int m_maxMatches;
+    const KateProjectSharedCancelFlag m_cancel;
+};
+
+#endif
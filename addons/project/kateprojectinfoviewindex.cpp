@@ -19,12 +19,29 @@
  */
 
 #include "kateprojectinfoviewindex.h"
+#include "kateprojectinfoviewindexmodel.h"
+#include "kateprojectindexqueryjob.h"
 #include "kateprojectpluginview.h"
 
+#include <ThreadWeaver/Queue>
+
 #include <QVBoxLayout>
 #include <klocalizedstring.h>
 #include <kmessagewidget.h>
 
+namespace
+{
+/**
+ * cap for the results of one query, short prefixes match a lot
+ */
+const int MaxMatches = 10000;
+
+/**
+ * delay after the last keystroke before we search
+ */
+const int QueryDelay = 150;
+}
+
 KateProjectInfoViewIndex::KateProjectInfoViewIndex(KateProjectPluginView *pluginView, KateProject *project)
     : QWidget()
     , m_pluginView(pluginView)
@@ -32,7 +49,8 @@ KateProjectInfoViewIndex::KateProjectInfoViewIndex(KateProjectPluginView *plugin
     , m_messageWidget(0)
     , m_lineEdit(new QLineEdit())
     , m_treeView(new QTreeView())
-    , m_model(new QStandardItemModel(m_treeView))
+    , m_model(new KateProjectInfoViewIndexModel(m_treeView))
+    , m_serial(0)
 {
     /**
      * default style
@@ -40,9 +58,10 @@ KateProjectInfoViewIndex::KateProjectInfoViewIndex(KateProjectPluginView *plugin
     m_treeView->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_treeView->setUniformRowHeights(true);
     m_treeView->setRootIsDecorated(false);
-    m_model->setHorizontalHeaderLabels(QStringList() << i18n("Name") << i18n("Kind") << i18n("File") << i18n("Line"));
     m_lineEdit->setPlaceholderText(i18n("Search"));
     m_lineEdit->setClearButtonEnabled(true);
+    m_queryTimer.setSingleShot(true);
+    m_queryTimer.setInterval(QueryDelay);
 
     /**
      * attach model
@@ -68,31 +87,80 @@ KateProjectInfoViewIndex::KateProjectInfoViewIndex(KateProjectPluginView *plugin
     connect(m_lineEdit, SIGNAL(textChanged(const QString &)), this, SLOT(slotTextChanged(const QString &)));
     connect(m_treeView, SIGNAL(clicked(const QModelIndex &)), this, SLOT(slotClicked(const QModelIndex &)));
     connect(m_project, SIGNAL(indexChanged()), this, SLOT(indexAvailable()));
+    connect(m_project, SIGNAL(indexChanged()), this, SLOT(slotStartQuery()));
+    connect(&m_queryTimer, SIGNAL(timeout()), this, SLOT(slotStartQuery()));
 
     /**
      * trigger once search with nothing
      */
-    slotTextChanged(QString());
+    slotStartQuery();
 }
 
 KateProjectInfoViewIndex::~KateProjectInfoViewIndex()
 {
+    /**
+     * running query is of no interest anymore
+     */
+    if (m_cancel) {
+        m_cancel->store(1);
+    }
 }
 
-void KateProjectInfoViewIndex::slotTextChanged(const QString &text)
+void KateProjectInfoViewIndex::slotTextChanged(const QString &)
 {
     /**
-     * init
+     * restart timer, we search once the user stops typing
      */
-    m_treeView->setSortingEnabled(false);
-    m_model->setRowCount(0);
+    m_queryTimer.start();
+}
+
+void KateProjectInfoViewIndex::slotStartQuery()
+{
+    m_queryTimer.stop();
 
     /**
-     * get results
+     * cancel running query, its results are outdated
      */
-    if (m_project->projectIndex() && !text.isEmpty()) {
-        m_project->projectIndex()->findMatches(*m_model, text, KateProjectIndex::FindMatches);
+    if (m_cancel) {
+        m_cancel->store(1);
+        m_cancel.clear();
     }
+    ++m_serial;
+
+    /**
+     * nothing to search => clear results
+     */
+    const QString text = m_lineEdit->text();
+    const KateProjectSharedProjectIndex index = m_project->sharedProjectIndex();
+    if (!index || text.isEmpty()) {
+        m_model->setMatches(KateProjectSharedIndexMatches());
+        return;
+    }
+
+    /**
+     * query in background, old results stay until the new ones arrive
+     */
+    m_cancel = KateProjectSharedCancelFlag(new QAtomicInt(0));
+    KateProjectIndexQueryJob *job = new KateProjectIndexQueryJob(m_serial, index, text, MaxMatches, m_cancel);
+    connect(job, &KateProjectIndexQueryJob::matchesFound, this, &KateProjectInfoViewIndex::slotMatchesFound);
+    m_pluginView->plugin()->queryWeaver()->stream() << job;
+}
+
+void KateProjectInfoViewIndex::slotMatchesFound(quint64 serial, KateProjectSharedIndexMatches matches)
+{
+    /**
+     * outdated query, ignore
+     */
+    if (serial != m_serial) {
+        return;
+    }
+    m_cancel.clear();
+
+    /**
+     * replace all results at once
+     */
+    m_treeView->setSortingEnabled(false);
+    m_model->setMatches(matches);
 
     /**
      * tree view polish ;)
@@ -108,7 +176,11 @@ void KateProjectInfoViewIndex::slotClicked(const QModelIndex &index)
     /**
      * get path
      */
-    QString filePath = m_model->item(index.row(), 2)->text();
+    if (!index.isValid()) {
+        return;
+    }
+    const KateProjectIndexMatch &match = m_model->match(index.row());
+    const QString filePath = match.file;
     if (filePath.isEmpty()) {
         return;
     }
@@ -124,7 +196,7 @@ void KateProjectInfoViewIndex::slotClicked(const QModelIndex &index)
     /**
      * set cursor, if possible
      */
-    int line = m_model->item(index.row(), 3)->text().toInt();
+    const int line = match.line;
     if (line >= 1) {
         view->setCursorPosition(KTextEditor::Cursor(line - 1, 0));
     }
@@ -22,11 +22,14 @@
 #define KATE_PROJECT_INFO_VIEW_INDEX_H
 
 #include "kateproject.h"
+#include "kateprojectcompletionjob.h"
 
 #include <QLineEdit>
+#include <QTimer>
 #include <QTreeView>
 
 class KateProjectPluginView;
+class KateProjectInfoViewIndexModel;
 class KMessageWidget;
 
 /**
@@ -61,10 +64,24 @@ public:
 private Q_SLOTS:
     /**
      * Called if text in lineedit changes, then we need to search
+     * Search is delayed a bit to not query for each keystroke.
      * @param text new text
      */
     void slotTextChanged(const QString &text);
 
+    /**
+     * Start background query for the current text.
+     * Cancels the running query, if any.
+     */
+    void slotStartQuery();
+
+    /**
+     * Results of a background query arrived.
+     * @param serial query serial, outdated results are ignored
+     * @param matches found matches
+     */
+    void slotMatchesFound(quint64 serial, KateProjectSharedIndexMatches matches);
+
     /**
      * item got clicked, do stuff, like open document
      * @param index model index of clicked item
@@ -104,9 +121,24 @@ private:
     QTreeView *m_treeView;
 
     /**
-     * standard item model for results
+     * model for results
+     */
+    KateProjectInfoViewIndexModel *m_model;
+
+    /**
+     * timer to delay the search while typing
+     */
+    QTimer m_queryTimer;
+
+    /**
+     * serial of the last started query
+     */
+    quint64 m_serial;
+
+    /**
+     * cancel flag of the running query, if any
      */
-    QStandardItemModel *m_model;
+    KateProjectSharedCancelFlag m_cancel;
 };
 
 #endif
@@ -0,0 +1,145 @@
+/*  This file is part of the Kate project.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectinfoviewindexmodel.h"
+
+#include <klocalizedstring.h>
+
+#include <algorithm>
+
+namespace
+{
+/**
+ * rows made available per fetchMore() call
+ */
+const int PageSize = 256;
+}
+
+KateProjectInfoViewIndexModel::KateProjectInfoViewIndexModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_matches(new QVector<KateProjectIndexMatch>())
+    , m_rowCount(0)
+{
+}
+
+void KateProjectInfoViewIndexModel::setMatches(const KateProjectSharedIndexMatches &matches)
+{
+    beginResetModel();
+    m_matches = matches ? matches : KateProjectSharedIndexMatches(new QVector<KateProjectIndexMatch>());
+    m_rowCount = qMin(PageSize, m_matches->size());
+    endResetModel();
+}
+
+int KateProjectInfoViewIndexModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int KateProjectInfoViewIndexModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant KateProjectInfoViewIndexModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= m_rowCount) {
+        return QVariant();
+    }
+
+    const KateProjectIndexMatch &match = m_matches->at(index.row());
+    switch (index.column()) {
+    case Name:
+        return match.name;
+    case Kind:
+        return match.kind;
+    case File:
+        return match.file;
+    case Line:
+        return match.line;
+    }
+
+    return QVariant();
+}
+
+QVariant KateProjectInfoViewIndexModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+    case Name:
+        return i18n("Name");
+    case Kind:
+        return i18n("Kind");
+    case File:
+        return i18n("File");
+    case Line:
+        return i18n("Line");
+    }
+
+    return QVariant();
+}
+
+bool KateProjectInfoViewIndexModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_rowCount < m_matches->size();
+}
+
+void KateProjectInfoViewIndexModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    const int newRowCount = qMin(m_rowCount + PageSize, m_matches->size());
+    beginInsertRows(QModelIndex(), m_rowCount, newRowCount - 1);
+    m_rowCount = newRowCount;
+    endInsertRows();
+}
+
+void KateProjectInfoViewIndexModel::sort(int column, Qt::SortOrder order)
+{
+    /**
+     * sort all matches, not only the fetched ones, the first page must be the right one
+     */
+    emit layoutAboutToBeChanged();
+
+    auto lessThan = [column](const KateProjectIndexMatch &a, const KateProjectIndexMatch &b) {
+        switch (column) {
+        case Kind:
+            return a.kind < b.kind;
+        case File:
+            return a.file < b.file;
+        case Line:
+            return a.line < b.line;
+        default:
+            return a.name < b.name;
+        }
+    };
+
+    if (order == Qt::AscendingOrder) {
+        std::stable_sort(m_matches->begin(), m_matches->end(), lessThan);
+    } else {
+        std::stable_sort(m_matches->begin(), m_matches->end(), [&lessThan](const KateProjectIndexMatch &a, const KateProjectIndexMatch &b) {
+            return lessThan(b, a);
+        });
+    }
+
+    emit layoutChanged();
+}
@@ -0,0 +1,90 @@
+/*  This file is part of the Kate project.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_INFO_VIEW_INDEX_MODEL_H
+#define KATE_PROJECT_INFO_VIEW_INDEX_MODEL_H
+
+#include "kateproject.h"
+
+#include <QAbstractTableModel>
+
+/**
+ * Model for the results of the index view.
+ * Holds the matches as plain vector and exposes them in pages,
+ * further rows are made available lazily via fetchMore().
+ */
+class KateProjectInfoViewIndexModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * columns of the model
+     */
+    enum Column {
+        Name,
+        Kind,
+        File,
+        Line,
+        ColumnCount
+    };
+
+    /**
+     * construct empty model
+     * @param parent parent object
+     */
+    explicit KateProjectInfoViewIndexModel(QObject *parent = nullptr);
+
+    /**
+     * Replace all matches at once.
+     * @param matches new matches, may be null
+     */
+    void setMatches(const KateProjectSharedIndexMatches &matches);
+
+    /**
+     * Access match for given row.
+     * @param row row, must be valid
+     * @return match in that row
+     */
+    const KateProjectIndexMatch &match(int row) const {
+        return m_matches->at(row);
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    /**
+     * all matches, only the first m_rowCount are exposed
+     */
+    KateProjectSharedIndexMatches m_matches;
+
+    /**
+     * number of rows fetched so far
+     */
+    int m_rowCount;
+};
+
+#endif
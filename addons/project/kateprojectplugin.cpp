@@ -66,14 +66,30 @@ KateProjectPlugin::KateProjectPlugin(QObject *parent, const QList<QVariant> &)
     , m_autoSubversion(true)
     , m_autoMercurial(true)
     , m_weaver(new ThreadWeaver::Queue(this))
+    , m_queryWeaver(new ThreadWeaver::Queue(this))
 {
+    /**
+     * index queries run one at a time, superseded ones get cancelled
+     */
+    m_queryWeaver->setMaximumNumberOfThreads(1);
+
     qRegisterMetaType<KateProjectSharedQStandardItem>("KateProjectSharedQStandardItem");
     qRegisterMetaType<KateProjectSharedQMapStringItem>("KateProjectSharedQMapStringItem");
     qRegisterMetaType<KateProjectSharedProjectIndex>("KateProjectSharedProjectIndex");
+    qRegisterMetaType<KateProjectSharedIndexMatches>("KateProjectSharedIndexMatches");
 
     connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentCreated, this, &KateProjectPlugin::slotDocumentCreated);
     connect(&m_fileWatcher, &QFileSystemWatcher::directoryChanged, this, &KateProjectPlugin::slotDirectoryChanged);
 
+    /**
+     * forward file list changes of all projects
+     */
+    connect(this, &KateProjectPlugin::projectCreated, this, [this](KateProject *project) {
+        connect(project, &KateProject::modelChanged, this, [this, project]() {
+            emit projectFilesChanged(project->fileName(), project->files());
+        });
+    });
+
 #ifdef HAVE_CTERMID
     /**
      * open project for our current working directory, if this kate has a terminal
@@ -104,6 +120,9 @@ KateProjectPlugin::~KateProjectPlugin()
     }
     m_projects.clear();
 
+    m_queryWeaver->shutDown();
+    delete m_queryWeaver;
+
     m_weaver->shutDown();
     delete m_weaver;
 }
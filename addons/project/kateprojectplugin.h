@@ -102,6 +102,15 @@ public:
         return m_document2Project.value(document);
     }
 
+    /**
+     * Queue for background queries on the project indices.
+     * Runs one job at a time, jobs should be cancellable.
+     * @return query queue
+     */
+    ThreadWeaver::Queue *queryWeaver() const {
+        return m_queryWeaver;
+    }
+
     void setAutoRepository(bool onGit, bool onSubversion, bool onMercurial);
     bool autoGit() const;
     bool autoSubversion() const;
@@ -114,6 +123,14 @@ Q_SIGNALS:
      */
     void projectCreated(KateProject *project);
 
+    /**
+     * Signal that the file list of a project got (re)loaded.
+     * Used by the application, e.g. to keep the quick open index current.
+     * @param projectFileName file name of the project
+     * @param files all files of the project
+     */
+    void projectFilesChanged(const QString &projectFileName, const QStringList &files);
+
 public Q_SLOTS:
     /**
      * New document got created, we need to update our connections
@@ -174,6 +191,11 @@ private:
     bool m_autoMercurial : 1;
 
     ThreadWeaver::Queue *m_weaver;
+
+    /**
+     * queue for index queries, see queryWeaver()
+     */
+    ThreadWeaver::Queue *m_queryWeaver;
 };
 
 #endif
@@ -93,6 +93,14 @@ public:
      */
     QStringList allProjectsFiles() const;
 
+    /**
+     * our plugin
+     * @return our plugin
+     */
+    KateProjectPlugin *plugin() const {
+        return m_plugin;
+    }
+
     /**
      * the main window we belong to
      * @return our main window
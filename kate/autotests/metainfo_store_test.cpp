@@ -0,0 +1,159 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "metainfo_store_test.h"
+#include "katemetainfostore.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+QTEST_MAIN(KateMetaInfoStoreTest)
+
+namespace
+{
+KateMetaInfoStore::Entries entries(const QString &cursor)
+{
+    KateMetaInfoStore::Entries entries;
+    entries.insert(QStringLiteral("Checksum"), QStringLiteral("abcdef"));
+    entries.insert(QStringLiteral("Cursor"), cursor);
+    return entries;
+}
+}
+
+void KateMetaInfoStoreTest::roundTrip()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/metainfos");
+
+    {
+        KateMetaInfoStore store(fileName);
+        store.put(QStringLiteral("file:///a.cpp"), entries(QStringLiteral("1,2")));
+        store.put(QStringLiteral("file:///b.cpp"), entries(QStringLiteral("3,4")));
+        store.put(QStringLiteral("file:///a.cpp"), entries(QStringLiteral("5,6")));
+        QCOMPARE(store.count(), 2);
+    }
+
+    KateMetaInfoStore store(fileName);
+    QCOMPARE(store.count(), 2);
+    QCOMPARE(store.entries(QStringLiteral("file:///a.cpp")), entries(QStringLiteral("5,6")));
+    QCOMPARE(store.entries(QStringLiteral("file:///b.cpp")), entries(QStringLiteral("3,4")));
+    QVERIFY(store.time(QStringLiteral("file:///a.cpp")) > 0);
+}
+
+void KateMetaInfoStoreTest::removeSurvivesReload()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/metainfos");
+
+    {
+        KateMetaInfoStore store(fileName);
+        store.put(QStringLiteral("file:///a.cpp"), entries(QStringLiteral("1,2")));
+        store.sync();
+        store.remove(QStringLiteral("file:///a.cpp"));
+    }
+
+    KateMetaInfoStore store(fileName);
+    QVERIFY(!store.contains(QStringLiteral("file:///a.cpp")));
+    QCOMPARE(store.count(), 0);
+}
+
+void KateMetaInfoStoreTest::expiredDroppedOnCompaction()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/metainfos");
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+    {
+        KateMetaInfoStore store(fileName);
+        store.put(QStringLiteral("file:///old.cpp"), entries(QStringLiteral("1,2")), now - 40 * 24 * 3600);
+        store.put(QStringLiteral("file:///new.cpp"), entries(QStringLiteral("3,4")), now - 2 * 24 * 3600);
+    }
+
+    {
+        KateMetaInfoStore store(fileName);
+        QCOMPARE(store.count(), 2);
+        store.setMaxAge(30);
+        store.sync();
+        QVERIFY(!store.contains(QStringLiteral("file:///old.cpp")));
+    }
+
+    KateMetaInfoStore store(fileName);
+    QCOMPARE(store.count(), 1);
+    QVERIFY(store.contains(QStringLiteral("file:///new.cpp")));
+}
+
+void KateMetaInfoStoreTest::brokenHeaderReplaced()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/metainfos");
+
+    /**
+     * simulate a crash in the middle of the first write
+     */
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("\x4b\x4d", 2);
+    file.close();
+
+    {
+        KateMetaInfoStore store(fileName);
+        QCOMPARE(store.count(), 0);
+        store.put(QStringLiteral("file:///a.cpp"), entries(QStringLiteral("1,2")));
+    }
+
+    KateMetaInfoStore store(fileName);
+    QCOMPARE(store.count(), 1);
+    QCOMPARE(store.entries(QStringLiteral("file:///a.cpp")), entries(QStringLiteral("1,2")));
+}
+
+void KateMetaInfoStoreTest::brokenTailIgnored()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/metainfos");
+
+    {
+        KateMetaInfoStore store(fileName);
+        store.put(QStringLiteral("file:///a.cpp"), entries(QStringLiteral("1,2")));
+    }
+
+    /**
+     * simulate a crash in the middle of an append
+     */
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("\x01\x00\x00", 3);
+    file.close();
+
+    {
+        KateMetaInfoStore store(fileName);
+        QCOMPARE(store.count(), 1);
+        QCOMPARE(store.entries(QStringLiteral("file:///a.cpp")), entries(QStringLiteral("1,2")));
+
+        /**
+         * records written after the broken tail must survive
+         */
+        store.put(QStringLiteral("file:///b.cpp"), entries(QStringLiteral("3,4")));
+    }
+
+    KateMetaInfoStore store(fileName);
+    QCOMPARE(store.count(), 2);
+    QCOMPARE(store.entries(QStringLiteral("file:///a.cpp")), entries(QStringLiteral("1,2")));
+    QCOMPARE(store.entries(QStringLiteral("file:///b.cpp")), entries(QStringLiteral("3,4")));
+}
@@ -0,0 +1,148 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+#include "quickopen_history_test.h"
+#include "katequickopenhistory.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+QTEST_MAIN(KateQuickOpenHistoryTest)
+
+namespace
+{
+qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+const qint64 Day = 24 * 3600;
+}
+
+void KateQuickOpenHistoryTest::recordAndReload()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/history");
+    const qint64 time = now();
+
+    {
+        KateQuickOpenHistory history(fileName);
+        history.record(QStringLiteral("/src/a.cpp"), KateQuickOpenHistory::Opened, time);
+        history.record(QStringLiteral("/src/b.cpp"), KateQuickOpenHistory::Activated, time);
+        history.record(QStringLiteral("/src/b.cpp"), KateQuickOpenHistory::Activated, time);
+        QCOMPARE(history.frecency(QStringLiteral("/src/a.cpp"), time), 2.0);
+        QCOMPARE(history.frecency(QStringLiteral("/src/b.cpp"), time), 2.0);
+    }
+
+    KateQuickOpenHistory history(fileName);
+    QCOMPARE(history.paths().size(), 2);
+    QCOMPARE(history.frecency(QStringLiteral("/src/a.cpp"), time), 2.0);
+    QCOMPARE(history.frecency(QStringLiteral("/src/b.cpp"), time), 2.0);
+    QCOMPARE(history.frecency(QStringLiteral("/src/unknown.cpp"), time), 0.0);
+}
+
+void KateQuickOpenHistoryTest::decayOrdering()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/history");
+    const qint64 time = now();
+
+    {
+        KateQuickOpenHistory history(fileName);
+
+        /**
+         * opened often four weeks ago vs. activated once today
+         */
+        for (int i = 0; i < 3; ++i) {
+            history.record(QStringLiteral("/src/old.cpp"), KateQuickOpenHistory::Opened, time - 28 * Day);
+        }
+        history.record(QStringLiteral("/src/new.cpp"), KateQuickOpenHistory::Activated, time);
+
+        /**
+         * events may come in out of order
+         */
+        history.record(QStringLiteral("/src/week.cpp"), KateQuickOpenHistory::Opened, time);
+        history.record(QStringLiteral("/src/week.cpp"), KateQuickOpenHistory::Opened, time - 7 * Day);
+    }
+
+    KateQuickOpenHistory history(fileName);
+    QCOMPARE(history.frecency(QStringLiteral("/src/old.cpp"), time), 0.375);
+    QCOMPARE(history.frecency(QStringLiteral("/src/new.cpp"), time), 1.0);
+    QCOMPARE(history.frecency(QStringLiteral("/src/week.cpp"), time), 3.0);
+    QVERIFY(history.frecency(QStringLiteral("/src/new.cpp"), time) > history.frecency(QStringLiteral("/src/old.cpp"), time));
+
+    /**
+     * one half-life later everything counts half
+     */
+    QCOMPARE(history.frecency(QStringLiteral("/src/week.cpp"), time + 7 * Day), 1.5);
+}
+
+void KateQuickOpenHistoryTest::tornLastLine()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/history");
+    const qint64 time = now();
+
+    {
+        KateQuickOpenHistory history(fileName);
+        history.record(QStringLiteral("/src/a.cpp"), KateQuickOpenHistory::Opened, time);
+    }
+
+    /**
+     * simulate a crash in the middle of an append
+     */
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write(QByteArray::number(time) + "\to\t2");
+    file.close();
+
+    {
+        KateQuickOpenHistory history(fileName);
+        QCOMPARE(history.paths().size(), 1);
+        QCOMPARE(history.frecency(QStringLiteral("/src/a.cpp"), time), 2.0);
+
+        /**
+         * records written after the torn line must survive
+         */
+        history.record(QStringLiteral("/src/b.cpp"), KateQuickOpenHistory::Activated, time);
+    }
+
+    KateQuickOpenHistory history(fileName);
+    QCOMPARE(history.paths().size(), 2);
+    QCOMPARE(history.frecency(QStringLiteral("/src/a.cpp"), time), 2.0);
+    QCOMPARE(history.frecency(QStringLiteral("/src/b.cpp"), time), 1.0);
+}
+
+void KateQuickOpenHistoryTest::batchedWrites()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QStringLiteral("/history");
+    const qint64 time = now();
+
+    KateQuickOpenHistory history(fileName);
+    history.record(QStringLiteral("/src/a.cpp"), KateQuickOpenHistory::Opened, time);
+    history.record(QStringLiteral("/src/b.cpp"), KateQuickOpenHistory::Activated, time);
+    QVERIFY(!QFile::exists(fileName));
+
+    history.flush();
+    KateQuickOpenHistory reloaded(fileName);
+    QCOMPARE(reloaded.paths().size(), 2);
+    QCOMPARE(reloaded.frecency(QStringLiteral("/src/a.cpp"), time), 2.0);
+    QCOMPARE(reloaded.frecency(QStringLiteral("/src/b.cpp"), time), 1.0);
+}
@@ -0,0 +1,172 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "quickopen_matcher_test.h"
+#include "katequickopenmatcher.h"
+
+#include <QtTest>
+
+#include <algorithm>
+
+QTEST_MAIN(KateQuickOpenMatcherTest)
+
+namespace
+{
+/**
+ * synthetic source tree paths
+ */
+QStringList syntheticPaths(int count)
+{
+    static const char *const dirs[] = { "src", "lib", "kernel", "drivers", "tests", "include", "tools", "docs" };
+    static const char *const names[] = { "main", "util", "parser", "ViewManager", "document_model", "config", "network", "buffer" };
+    static const char *const exts[] = { ".cpp", ".h", ".c", ".py" };
+
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        paths.append(QStringLiteral("/home/user/project/%1/%2/sub%3/%4%5%6")
+                     .arg(QLatin1String(dirs[i % 8]))
+                     .arg(QLatin1String(dirs[(i / 8) % 8]))
+                     .arg(i % 97)
+                     .arg(QLatin1String(names[(i / 64) % 8]))
+                     .arg(i)
+                     .arg(QLatin1String(exts[i % 4])));
+    }
+    return paths;
+}
+}
+
+void KateQuickOpenMatcherTest::emptyPattern()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList() << QStringLiteral("/a/b.cpp") << QStringLiteral("/a/c.cpp") << QStringLiteral("/a/d.cpp"));
+
+    const QVector<KateQuickOpenMatcher::Match> matches = matcher.match(QString(), 10);
+    QCOMPARE(matches.size(), 3);
+    QCOMPARE(matches.at(0).id, 0);
+    QCOMPARE(matches.at(1).id, 1);
+    QCOMPARE(matches.at(2).id, 2);
+}
+
+void KateQuickOpenMatcherTest::noMatch()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList() << QStringLiteral("/src/main.cpp") << QStringLiteral("/src/util.h"));
+
+    QVERIFY(matcher.match(QStringLiteral("xyz"), 10).isEmpty());
+    QVERIFY(matcher.match(QStringLiteral("hcu"), 10).isEmpty());
+    QCOMPARE(matcher.match(QStringLiteral("uh"), 10).size(), 1);
+}
+
+void KateQuickOpenMatcherTest::caseInsensitive()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList() << QStringLiteral("/src/KateViewManager.cpp"));
+
+    QCOMPARE(matcher.match(QStringLiteral("kvm"), 10).size(), 1);
+    QCOMPARE(matcher.match(QStringLiteral("KVM"), 10).size(), 1);
+}
+
+void KateQuickOpenMatcherTest::fileNameWins()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList() << QStringLiteral("/main/sub/other.cpp") << QStringLiteral("/src/sub/main.cpp"));
+
+    const QVector<KateQuickOpenMatcher::Match> matches = matcher.match(QStringLiteral("main"), 10);
+    QCOMPARE(matches.size(), 2);
+    QCOMPARE(matches.at(0).id, 1);
+}
+
+void KateQuickOpenMatcherTest::boundaryWins()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList() << QStringLiteral("/src/kateviewmanager.cpp") << QStringLiteral("/src/KateViewManager.cpp"));
+
+    const QVector<KateQuickOpenMatcher::Match> matches = matcher.match(QStringLiteral("kvm"), 10);
+    QCOMPARE(matches.size(), 2);
+    QCOMPARE(matches.at(0).id, 1);
+    QVERIFY(matches.at(0).score > matches.at(1).score);
+}
+
+void KateQuickOpenMatcherTest::maxResults()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(syntheticPaths(1000));
+
+    const QVector<KateQuickOpenMatcher::Match> matches = matcher.match(QStringLiteral("main"), 7);
+    QCOMPARE(matches.size(), 7);
+    for (int i = 1; i < matches.size(); ++i) {
+        QVERIFY(matches.at(i - 1).score >= matches.at(i).score);
+    }
+}
+
+void KateQuickOpenMatcherTest::parallelMatchesSerial()
+{
+    const QStringList paths = syntheticPaths(200000);
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(paths);
+
+    /**
+     * the parallel result must match a plain serial scoring pass
+     */
+    const QByteArray pattern = KateQuickOpenMatcher::preparePattern(QStringLiteral("drvvm"));
+    QVector<KateQuickOpenMatcher::Match> expected;
+    for (int id = 0; id < matcher.size(); ++id) {
+        const int score = matcher.score(id, pattern);
+        if (score >= 0) {
+            const KateQuickOpenMatcher::Match match = { id, score };
+            expected.append(match);
+        }
+    }
+    std::stable_sort(expected.begin(), expected.end(), [](const KateQuickOpenMatcher::Match &a, const KateQuickOpenMatcher::Match &b) {
+        return a.score > b.score;
+    });
+    expected.resize(qMin(expected.size(), 100));
+
+    const QVector<KateQuickOpenMatcher::Match> matches = matcher.match(QStringLiteral("drvvm"), 100);
+    QCOMPARE(matches.size(), expected.size());
+    for (int i = 0; i < matches.size(); ++i) {
+        QCOMPARE(matches.at(i).id, expected.at(i).id);
+        QCOMPARE(matches.at(i).score, expected.at(i).score);
+    }
+}
+
+void KateQuickOpenMatcherTest::benchmark_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("one char") << QStringLiteral("m");
+    QTest::newRow("two chars") << QStringLiteral("vm");
+    QTest::newRow("file name") << QStringLiteral("parser12");
+    QTest::newRow("scattered") << QStringLiteral("krnsub3dm");
+    QTest::newRow("no match") << QStringLiteral("zzzq");
+}
+
+void KateQuickOpenMatcherTest::benchmark()
+{
+    QFETCH(QString, pattern);
+
+    static KateQuickOpenMatcher matcher;
+    if (!matcher.size()) {
+        matcher.setCandidates(syntheticPaths(500000));
+    }
+
+    QBENCHMARK {
+        matcher.match(pattern, 512);
+    }
+}
@@ -24,6 +24,7 @@
 #include <KConfigGroup>
 
 #include <QtTestWidgets>
+#include <QStandardPaths>
 #include <QTemporaryDir>
 #include <QCommandLineParser>
 
@@ -31,6 +32,9 @@ QTEST_MAIN(KateSessionManagerTest)
 
 void KateSessionManagerTest::initTestCase()
 {
+    // the session index goes to the cache location, keep it out of the user's home
+    QStandardPaths::setTestModeEnabled(true);
+
     m_app = new KateApp(QCommandLineParser()); // FIXME: aaaah, why, why, why?!
 }
 
@@ -149,6 +153,9 @@ void KateSessionManagerTest::deletingSessionFilesUnderRunningApp()
     QVERIFY(m_manager->sessionList().size() == 2);
     QVERIFY(m_manager->activeSession()->name() == QLatin1String("bar"));
 
+    // the last save of foo happens in the background
+    m_manager->waitForWrites();
+
     const QString file = m_tempdir->path() + QLatin1String("/foo.katesession");
     QVERIFY(QFile(file).remove());
 
@@ -165,4 +172,24 @@ void KateSessionManagerTest::startNonEmpty()
     QCOMPARE(m.sessionList().size(), 2);
 }
 
+void KateSessionManagerTest::documentCounts()
+{
+    m_manager->activateSession(QLatin1String("foo"), false, false);
+    m_manager->activateSession(QLatin1String("bar"), false, false);
 
+    const QString file = m_tempdir->path() + QLatin1String("/foo.katesession");
+    KConfig config(file, KConfig::SimpleConfig);
+    config.group("Open Documents").writeEntry("Count", 3);
+    config.sync();
+
+    // counts of changed files get read in the background, first start reads them at once
+    KateSessionManager m(this, m_tempdir->path());
+    KateSession::Ptr s;
+    foreach(const KateSession::Ptr & session, m.sessionList()) {
+        if (session->name() == QLatin1String("foo")) {
+            s = session;
+        }
+    }
+    QVERIFY(s);
+    QTRY_COMPARE_WITH_TIMEOUT(s->documents(), 3u, 1000);
+}
@@ -22,6 +22,7 @@
 #include "kateapp.h"
 
 #include <QtTestWidgets>
+#include <QStandardPaths>
 #include <QTemporaryDir>
 #include <QActionGroup>
 #include <QCommandLineParser>
@@ -30,6 +31,9 @@ QTEST_MAIN(KateSessionsActionTest)
 
 void KateSessionsActionTest::initTestCase()
 {
+    // the session managers write their index into the cache location
+    QStandardPaths::setTestModeEnabled(true);
+
     m_app = new KateApp(QCommandLineParser()); // FIXME: aaaah, why, why, why?!
 }
 
@@ -21,6 +21,7 @@
 
 #include "kateviewmanager.h"
 #include "katemainwindow.h"
+#include "katetrace.h"
 
 #include <KConfig>
 #include <KSharedConfig>
@@ -52,6 +53,7 @@ KateApp::KateApp(const QCommandLineParser &args)
     , m_adaptor(this)
     , m_pluginManager(this)
     , m_sessionManager(this)
+    , m_quickOpenIndex(&m_docManager, &m_wrapper)
 {
     /**
      * re-route some signals to application wrapper
@@ -111,6 +113,8 @@ bool KateApp::init()
 
 void KateApp::restoreKate()
 {
+    KateTraceScope trace("KateApp::restoreKate");
+
     KConfig *sessionConfig = KConfigGui::sessionConfig();
 
     // activate again correct session!!!
@@ -136,6 +140,8 @@ void KateApp::restoreKate()
 
 bool KateApp::startupKate()
 {
+    KateTraceScope trace("KateApp::startupKate");
+
     // user specified session to open
     if (m_args.isSet(QStringLiteral("start"))) {
         sessionManager()->activateSession(m_args.value(QStringLiteral("start")), false);
@@ -260,6 +266,11 @@ KateSessionManager *KateApp::sessionManager()
     return &m_sessionManager;
 }
 
+KateQuickOpenIndex *KateApp::quickOpenIndex()
+{
+    return &m_quickOpenIndex;
+}
+
 bool KateApp::openUrl(const QUrl &url, const QString &encoding, bool isTempFile)
 {
     return openDocUrl(url, encoding, isTempFile);
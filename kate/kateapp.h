@@ -29,6 +29,7 @@
 #include "katepluginmanager.h"
 #include "katesessionmanager.h"
 #include "kateappadaptor.h"
+#include "katequickopenindex.h"
 
 #include <KConfig>
 #include <QList>
@@ -130,6 +131,12 @@ public:
      */
     KateSessionManager *sessionManager();
 
+    /**
+     * accessor to quick open index, shared by all main windows
+     * @return quick open index instance
+     */
+    KateQuickOpenIndex *quickOpenIndex();
+
     /**
      * window management
      */
@@ -245,20 +252,47 @@ public Q_SLOTS:
     /**
      * Get a list of all documents that are managed by the application.
      * This might contain less documents than the editor has in his documents () list.
+     * Placeholders of a lazy session restore are left out until they are loaded,
+     * plugins expect documents with content and url.
      * @return all documents the application manages
      */
     QList<KTextEditor::Document *> documents() {
-        return m_docManager.documentList();
+        return m_docManager.loadedDocumentList();
     }
 
     /**
      * Get the document with the URL \p url.
      * if multiple documents match the searched url, return the first found one...
+     * A placeholder of a lazy session restore gets loaded first.
      * \param url the document's URL
      * \return the document with the given \p url or NULL, if none found
      */
     KTextEditor::Document *findUrl(const QUrl &url) {
-        return m_docManager.findDocument(url);
+        KTextEditor::Document *doc = m_docManager.findDocument(url);
+        if (doc) {
+            m_docManager.loadPlaceholder(doc);
+        }
+        return doc;
+    }
+
+    /**
+     * Get a list of all documents, including the placeholders of a lazy
+     * session restore. Not part of KTextEditor::Application, the file tree
+     * calls it via invokeMethod to list unloaded session files.
+     * @return all documents
+     */
+    QList<KTextEditor::Document *> documentsWithPlaceholders() {
+        return m_docManager.documentList();
+    }
+
+    /**
+     * Get the url of a document, for placeholders the url they will load.
+     * Not part of KTextEditor::Application, see documentsWithPlaceholders().
+     * \param document the document
+     * \return the document's url
+     */
+    QUrl documentUrl(KTextEditor::Document *document) {
+        return m_docManager.documentUrl(document);
     }
 
     /**
@@ -361,6 +395,11 @@ private:
      * session manager
      */
     KateSessionManager m_sessionManager;
+
+    /**
+     * quick open index
+     */
+    KateQuickOpenIndex m_quickOpenIndex;
 };
 
 #endif
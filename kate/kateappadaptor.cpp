@@ -22,6 +22,7 @@
 #include "katesessionmanager.h"
 #include "katedocmanager.h"
 #include "katemainwindow.h"
+#include "katefileprefetcher.h"
 
 #include "katedebug.h"
 #include <KWindowSystem>
@@ -89,6 +90,39 @@ QString KateAppAdaptor::tokenOpenUrlAt(QString url, int line, int column, QStrin
     m_app->setCursor(line, column);
     return QString::fromLatin1("%1").arg((qptrdiff)doc);
 }
+
+QStringList KateAppAdaptor::tokenOpenUrlsAt(QStringList urls, QList<int> lines, QList<int> columns, QString encoding, bool isTempFile, bool activate)
+{
+    qCDebug(LOG_KATE) << "openURLsAt" << urls.size();
+
+    QList<QUrl> fileUrls;
+    for (const QString &url : urls) {
+        fileUrls.append(QUrl(url));
+    }
+
+    /**
+     * read the files in parallel while we open them one after the other
+     */
+    KateFilePrefetcher prefetcher(fileUrls);
+
+    QStringList tokens;
+    for (int i = 0; i < fileUrls.size(); ++i) {
+        prefetcher.waitFor(fileUrls.at(i));
+        KTextEditor::Document *doc = m_app->openDocUrl(fileUrls.at(i), encoding, isTempFile);
+        if (!doc) {
+            tokens.append(QStringLiteral("ERROR"));
+            continue;
+        }
+        m_app->setCursor(lines.value(i, -1), columns.value(i, -1));
+        tokens.append(QString::fromLatin1("%1").arg((qptrdiff)doc));
+    }
+
+    if (activate) {
+        this->activate();
+    }
+
+    return tokens;
+}
 //--------
 
 bool KateAppAdaptor::setCursor(int line, int column)
@@ -69,6 +69,19 @@ public Q_SLOTS:
 
     QString tokenOpenUrlAt(QString url, int line, int column, QString encoding, bool isTempFile);
 
+    /**
+     * open many files at once, each with its cursor, and optionally activate this instance
+     * one call instead of one tokenOpenUrlAt per file, the files are prefetched in parallel
+     * @param urls urls of the files
+     * @param lines line for the cursor per url
+     * @param columns column for the cursor per url
+     * @param encoding encoding name
+     * @param isTempFile see openUrl
+     * @param activate activate this instance afterwards
+     * @return token or ERROR per url
+     */
+    QStringList tokenOpenUrlsAt(QStringList urls, QList<int> lines, QList<int> columns, QString encoding, bool isTempFile, bool activate);
+
     /**
      * set cursor of active view in active main window
      * will clear selection
@@ -25,6 +25,8 @@
 #include "kateviewmanager.h"
 #include "katesavemodifieddialog.h"
 #include "katedebug.h"
+#include "katefileprefetcher.h"
+#include "katetrace.h"
 
 #include <ktexteditor/view.h>
 #include <ktexteditor/editor.h>
@@ -44,15 +46,80 @@
 #include <QApplication>
 #include <QListView>
 #include <QProgressDialog>
+#include <QStandardPaths>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QVector>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+/**
+ * Cheap identity of a local file: size, modification time and inode.
+ * While it is unchanged, the checksum stored in the meta infos is still valid.
+ * Empty for non-local or missing files.
+ */
+static QString metaInfoFileKey(const QUrl &url)
+{
+    if (!url.isLocalFile()) {
+        return QString();
+    }
+
+    const QFileInfo fi(url.toLocalFile());
+    if (!fi.exists()) {
+        return QString();
+    }
+
+    quint64 inode = 0;
+#ifdef Q_OS_UNIX
+    struct stat buf;
+    if (::stat(QFile::encodeName(fi.filePath()).constData(), &buf) == 0) {
+        inode = buf.st_ino;
+    }
+#endif
+
+    return QStringLiteral("%1:%2:%3").arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch()).arg(inode);
+}
+
+/**
+ * quiet time and maximal delay before modified on disk notifications are handed on
+ */
+static const int ModOnDiskDelay = 200;
+static const int ModOnDiskMaxDelay = 2000;
+
+/**
+ * time a bulk reload or save may block the event loop in one go
+ */
+static const int BulkSliceTime = 50;
 
 KateDocManager::KateDocManager(QObject *parent)
     : QObject(parent)
-    , m_metaInfos(QStringLiteral("katemetainfos"), KConfig::NoGlobals)
+    , m_metaInfos(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kate/metainfos"))
+    , m_placeholderConfig(QString(), KConfig::SimpleConfig)
+    , m_placeholderPrefetcher(0)
+    , m_sessionConfigCache(QString(), KConfig::SimpleConfig)
+    , m_bulkRunning(false)
+    , m_bulkReload(false)
+    , m_bulkDone(0)
+    , m_bulkPrefetcher(0)
     , m_saveMetaInfos(true)
     , m_daysMetaInfos(0)
     , m_documentStillToRestore(0)
 {
+    // take over the meta infos of the old KConfig based store
+    importMetaInfos();
+
+    // bulk reload and save, in slices
+    m_bulkTimer.setSingleShot(true);
+    m_bulkTimer.setInterval(0);
+    connect(&m_bulkTimer, SIGNAL(timeout()), this, SLOT(processBulkSlice()));
+
+    // coalesce modified on disk notifications
+    m_modOnDiskTimer.setSingleShot(true);
+    m_modOnDiskTimer.setInterval(ModOnDiskDelay);
+    connect(&m_modOnDiskTimer, SIGNAL(timeout()), this, SLOT(flushModifiedOnDisc()));
+
     // set our application wrapper
     KTextEditor::Editor::instance()->setApplication(KateApp::self()->wrapper());
 
@@ -65,21 +132,15 @@ KateDocManager::~KateDocManager()
     // write metainfos?
     if (m_saveMetaInfos) {
         // saving meta-infos when file is saved is not enough, we need to do it once more at the end
+        // expired infos are purged by the store while compacting
         saveMetaInfos(m_docList);
-
-        // purge saved filesessions
-        if (m_daysMetaInfos > 0) {
-            const QStringList groups = m_metaInfos.groupList();
-            QDateTime def(QDate(1970, 1, 1));
-            for (QStringList::const_iterator it = groups.begin(); it != groups.end(); ++it) {
-                QDateTime last = m_metaInfos.group(*it).readEntry("Time", def);
-                if (last.daysTo(QDateTime::currentDateTimeUtc()) > m_daysMetaInfos) {
-                    m_metaInfos.deleteGroup(*it);
-                }
-            }
-        }
     }
 
+    // abort bulk reload or save still running
+    delete m_bulkProgress;
+    delete m_bulkPrefetcher;
+    delete m_placeholderPrefetcher;
+
     qDeleteAll(m_docInfos);
 }
 
@@ -97,10 +158,27 @@ KTextEditor::Document *KateDocManager::createDoc(const KateDocumentInfo &docInfo
     m_docList.append(doc);
     m_docInfos.insert(doc, new KateDocumentInfo(docInfo));
 
+    // placeholders: make the url known before the world sees the document, see documentUrl()
+    if (!docInfo.placeholderUrl.isEmpty()) {
+        m_placeholders.append(doc);
+        indexDocument(doc);
+    }
+
     // connect internal signals...
     connect(doc, SIGNAL(modifiedChanged(KTextEditor::Document*)), this, SLOT(slotModChanged1(KTextEditor::Document*)));
     connect(doc, SIGNAL(modifiedOnDisk(KTextEditor::Document*,bool,KTextEditor::ModificationInterface::ModifiedOnDiskReason)),
             this, SLOT(slotModifiedOnDisc(KTextEditor::Document*,bool,KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
+    connect(doc, SIGNAL(documentUrlChanged(KTextEditor::Document*)), this, SLOT(slotUrlChanged(KTextEditor::Document*)));
+
+    // track changes of the session config, see saveDocumentList()
+    m_sessionConfigDirty.insert(doc);
+    connect(doc, SIGNAL(documentUrlChanged(KTextEditor::Document*)), this, SLOT(slotSessionConfigChanged(KTextEditor::Document*)));
+    connect(doc, SIGNAL(modeChanged(KTextEditor::Document*)), this, SLOT(slotSessionConfigChanged(KTextEditor::Document*)));
+    connect(doc, SIGNAL(highlightingModeChanged(KTextEditor::Document*)), this, SLOT(slotSessionConfigChanged(KTextEditor::Document*)));
+    connect(doc, SIGNAL(reloaded(KTextEditor::Document*)), this, SLOT(slotSessionConfigChanged(KTextEditor::Document*)));
+    connect(doc, SIGNAL(documentSavedOrUploaded(KTextEditor::Document*,bool)), this, SLOT(slotSessionConfigChanged(KTextEditor::Document*)));
+    connect(doc, SIGNAL(marksChanged(KTextEditor::Document*)), this, SLOT(slotSessionConfigChanged(KTextEditor::Document*)));
+    connect(doc, SIGNAL(viewCreated(KTextEditor::Document*,KTextEditor::View*)), this, SLOT(slotViewCreated(KTextEditor::Document*,KTextEditor::View*)));
 
     // we have a new document, show it the world
     emit documentCreated(doc);
@@ -115,17 +193,136 @@ KateDocumentInfo *KateDocManager::documentInfo(KTextEditor::Document *doc)
     return m_docInfos.contains(doc) ? m_docInfos[doc] : 0;
 }
 
+bool KateDocManager::isPlaceholder(KTextEditor::Document *doc) const
+{
+    const KateDocumentInfo *info = m_docInfos.value(doc);
+    return info && !info->placeholderUrl.isEmpty();
+}
+
+QUrl KateDocManager::documentUrl(KTextEditor::Document *doc) const
+{
+    return isPlaceholder(doc) ? m_docInfos.value(doc)->placeholderUrl : doc->url();
+}
+
+QString KateDocManager::documentName(KTextEditor::Document *doc) const
+{
+    return isPlaceholder(doc) ? m_docInfos.value(doc)->placeholderUrl.fileName() : doc->documentName();
+}
+
+QList<KTextEditor::Document *> KateDocManager::loadedDocumentList() const
+{
+    if (m_placeholders.isEmpty()) {
+        return m_docList;
+    }
+
+    QList<KTextEditor::Document *> docs;
+    foreach(KTextEditor::Document * doc, m_docList) {
+        if (!isPlaceholder(doc)) {
+            docs.append(doc);
+        }
+    }
+    return docs;
+}
+
+void KateDocManager::loadPlaceholder(KTextEditor::Document *doc)
+{
+    if (!isPlaceholder(doc)) {
+        return;
+    }
+
+    KateDocumentInfo *info = m_docInfos.value(doc);
+    info->placeholderUrl.clear();
+    m_placeholders.removeOne(doc);
+
+    // this loads the file, like a normal session restore
+    const QString group = QString::number((qptrdiff)doc);
+    doc->readSessionConfig(KConfigGroup(&m_placeholderConfig, group));
+    m_placeholderConfig.deleteGroup(group);
+    m_sessionConfigDirty.insert(doc);
+
+    if (doc->openingError()) {
+        info->openSuccess = false;
+    }
+
+    indexDocument(doc);
+}
+
+void KateDocManager::slotSessionConfigChanged(KTextEditor::Document *doc)
+{
+    m_sessionConfigDirty.insert(doc);
+}
+
+void KateDocManager::slotViewCreated(KTextEditor::Document *, KTextEditor::View *view)
+{
+    // settings changed by the user happen while a view has the focus
+    connect(view, SIGNAL(focusOut(KTextEditor::View*)), this, SLOT(slotViewFocusOut(KTextEditor::View*)));
+}
+
+void KateDocManager::slotViewFocusOut(KTextEditor::View *view)
+{
+    m_sessionConfigDirty.insert(view->document());
+}
+
 KTextEditor::Document *KateDocManager::findDocument(const QUrl &url) const
 {
     QUrl u(url.adjusted(QUrl::NormalizePathSegments));
 
-    foreach(KTextEditor::Document * it, m_docList) {
-        if (it->url() == u) {
-            return it;
+    /**
+     * untitled documents are not hashed, rare case, just search them
+     */
+    if (u.isEmpty()) {
+        foreach(KTextEditor::Document * it, m_docList) {
+            if (it->url().isEmpty()) {
+                return it;
+            }
         }
+        return 0;
+    }
+
+    /**
+     * more than one document with the same url is rare (save as over an opened file)
+     * keep the old behavior and prefer the first one in the document list then
+     */
+    const QList<KTextEditor::Document *> docs = m_docsByUrl.values(u);
+    if (docs.size() <= 1) {
+        return docs.value(0);
+    }
+
+    KTextEditor::Document *first = 0;
+    int firstIndex = m_docList.size();
+    foreach(KTextEditor::Document * it, docs) {
+        const int index = m_docList.indexOf(it);
+        if (index < firstIndex) {
+            first = it;
+            firstIndex = index;
+        }
+    }
+    return first;
+}
+
+void KateDocManager::indexDocument(KTextEditor::Document *doc)
+{
+    unindexDocument(doc);
+
+    const QUrl u(documentUrl(doc).adjusted(QUrl::NormalizePathSegments));
+    if (!u.isEmpty()) {
+        m_docsByUrl.insert(u, doc);
+        m_docUrls.insert(doc, u);
     }
+}
+
+void KateDocManager::unindexDocument(KTextEditor::Document *doc)
+{
+    const auto it = m_docUrls.find(doc);
+    if (it != m_docUrls.end()) {
+        m_docsByUrl.remove(it.value(), doc);
+        m_docUrls.erase(it);
+    }
+}
 
-    return 0;
+void KateDocManager::slotUrlChanged(KTextEditor::Document *doc)
+{
+    indexDocument(doc);
 }
 
 QList<KTextEditor::Document *> KateDocManager::openUrls(const QList<QUrl> &urls, const QString &encoding, bool isTempFile, const KateDocumentInfo &docInfo)
@@ -134,7 +331,11 @@ QList<KTextEditor::Document *> KateDocManager::openUrls(const QList<QUrl> &urls,
 
     emit aboutToCreateDocuments();
 
+    // read the files in parallel, the documents load them one after the other from the cache
+    KateFilePrefetcher prefetcher(urls);
+
     foreach(const QUrl & url, urls) {
+        prefetcher.waitFor(url);
         docs << openUrl(url, encoding, isTempFile, docInfo);
     }
 
@@ -175,6 +376,9 @@ KTextEditor::Document *KateDocManager::openUrl(const QUrl &url, const QString &e
             if (!loadMetaInfos(doc, u)) {
                 doc->openUrl(u);
             }
+
+            // be independent of the part emitting documentUrlChanged during open
+            indexDocument(doc);
         }
     }
 
@@ -238,7 +442,18 @@ bool KateDocManager::closeDocuments(const QList<KTextEditor::Document *> documen
         // document will be deleted, soon
         emit documentWillBeDeleted(doc);
 
+        // forget placeholder state
+        if (isPlaceholder(doc)) {
+            m_placeholders.removeOne(doc);
+            m_placeholderConfig.deleteGroup(QString::number((qptrdiff)doc));
+        }
+        m_sessionConfigDirty.remove(doc);
+        m_modOnDiskPending.remove(doc);
+        m_bulkDocs.removeAll(doc);
+        m_sessionConfigCache.deleteGroup(QString::number((qptrdiff)doc));
+
         // really delete the document and its infos
+        unindexDocument(doc);
         delete m_docInfos.take(doc);
         delete m_docList.takeAt(m_docList.indexOf(doc));
 
@@ -366,10 +581,14 @@ bool KateDocManager::queryCloseDocuments(KateMainWindow *w)
 
 void KateDocManager::saveAll()
 {
-    foreach(KTextEditor::Document * doc, m_docList)
-    if (doc->isModified()) {
-        doc->documentSave();
+    QList<KTextEditor::Document *> docs;
+    foreach(KTextEditor::Document * doc, m_docList) {
+        if (doc->isModified()) {
+            docs.append(doc);
+        }
     }
+
+    startBulk(false, docs);
 }
 
 void KateDocManager::saveSelected(const QList<KTextEditor::Document *> &docList)
@@ -383,15 +602,98 @@ void KateDocManager::saveSelected(const QList<KTextEditor::Document *> &docList)
 
 void KateDocManager::reloadAll()
 {
-    // reload all docs that are NOT modified on disk
+    // reload all docs that are NOT modified on disk, placeholders are not loaded anyway
+    QList<KTextEditor::Document *> docs;
     foreach(KTextEditor::Document * doc, m_docList) {
-        if (! documentInfo(doc)->modifiedOnDisc) {
+        if (!documentInfo(doc)->modifiedOnDisc && !isPlaceholder(doc)) {
+            docs.append(doc);
+        }
+    }
+
+    startBulk(true, docs);
+}
+
+void KateDocManager::startBulk(bool reload, const QList<KTextEditor::Document *> &docs)
+{
+    // one bulk operation at a time, the documents are collected again once it is our turn
+    if (m_bulkRunning) {
+        if (!m_bulkQueue.contains(reload)) {
+            m_bulkQueue.append(reload);
+        }
+        return;
+    }
+
+    m_bulkRunning = true;
+    m_bulkDocs = docs;
+    m_bulkReload = reload;
+    m_bulkDone = 0;
+
+    if (reload) {
+        QList<QUrl> urls;
+        foreach(KTextEditor::Document * doc, docs) {
+            urls.append(doc->url());
+        }
+        m_bulkPrefetcher = new KateFilePrefetcher(urls);
+    }
+
+    m_bulkProgress = new QProgressDialog(KateApp::self()->activeKateMainWindow());
+    m_bulkProgress->setWindowTitle(reload ? i18n("Reloading") : i18n("Saving"));
+    m_bulkProgress->setLabelText(reload ? i18n("Reloading all documents...") : i18n("Saving all documents..."));
+    m_bulkProgress->setRange(0, docs.size());
+    m_bulkProgress->setMinimumDuration(500);
+
+    // small jobs are done right now, like before
+    processBulkSlice();
+}
+
+void KateDocManager::processBulkSlice()
+{
+    QElapsedTimer slice;
+    slice.start();
+    while (!m_bulkDocs.isEmpty() && slice.elapsed() < BulkSliceTime) {
+        // no progress any more: its window got closed
+        if (!m_bulkProgress || m_bulkProgress->wasCanceled()) {
+            m_bulkDocs.clear();
+            break;
+        }
+
+        KTextEditor::Document *doc = m_bulkDocs.takeFirst();
+        if (m_bulkReload) {
+            m_bulkPrefetcher->waitFor(doc->url());
             doc->documentReload();
+        } else if (doc->isModified()) {
+            doc->documentSave();
+        }
+        if (m_bulkProgress) {
+            m_bulkProgress->setValue(++m_bulkDone);
         }
     }
 
+    // more to do? let the event loop run first
+    if (!m_bulkDocs.isEmpty()) {
+        m_bulkTimer.start();
+        return;
+    }
+
+    const bool canceled = !m_bulkProgress || m_bulkProgress->wasCanceled();
+    delete m_bulkProgress;
+    delete m_bulkPrefetcher;
+    m_bulkPrefetcher = 0;
+    m_bulkRunning = false;
+
     // take care of all documents that ARE modified on disk
-    KateApp::self()->activeKateMainWindow()->showModOnDiskPrompt();
+    if (m_bulkReload && !canceled && KateApp::self()->activeKateMainWindow()) {
+        KateApp::self()->activeKateMainWindow()->showModOnDiskPrompt();
+    }
+
+    // next queued request, with the documents that need it now
+    if (!m_bulkRunning && !m_bulkQueue.isEmpty()) {
+        if (m_bulkQueue.takeFirst()) {
+            reloadAll();
+        } else {
+            saveAll();
+        }
+    }
 }
 
 void KateDocManager::closeOrphaned()
@@ -414,16 +716,37 @@ void KateDocManager::saveDocumentList(KConfig *config)
 
     openDocGroup.writeEntry("Count", m_docList.count());
 
+    // active documents might have changed in ways we get no signal for, e.g. indentation mode
+    for (int i = 0; i < KateApp::self()->mainWindowsCount(); ++i) {
+        if (KTextEditor::View *view = KateApp::self()->mainWindow(i)->viewManager()->activeView()) {
+            m_sessionConfigDirty.insert(view->document());
+        }
+    }
+
     int i = 0;
     foreach(KTextEditor::Document * doc, m_docList) {
         KConfigGroup cg(config, QString::fromLatin1("Document %1").arg(i));
-        doc->writeSessionConfig(cg);
+        if (isPlaceholder(doc)) {
+            // not loaded yet, pass on the config it got restored with
+            KConfigGroup(&m_placeholderConfig, QString::number((qptrdiff)doc)).copyTo(&cg);
+        } else {
+            // only documents that changed since the last save get serialized again
+            KConfigGroup cached(&m_sessionConfigCache, QString::number((qptrdiff)doc));
+            if (m_sessionConfigDirty.contains(doc) || !cached.exists()) {
+                doc->writeSessionConfig(cached);
+            }
+            cached.copyTo(&cg);
+        }
         i++;
     }
+
+    m_sessionConfigDirty.clear();
 }
 
 void KateDocManager::restoreDocumentList(KConfig *config)
 {
+    KateTraceScope trace("KateDocManager::restoreDocumentList");
+
     KConfigGroup openDocGroup(config, "Open Documents");
     unsigned int count = openDocGroup.readEntry("Count", 0);
 
@@ -438,12 +761,54 @@ void KateDocManager::restoreDocumentList(KConfig *config)
     progress.setCancelButton(0);
     progress.setRange(0, count);
 
+    /**
+     * lazy restore: documents start as placeholders, loaded on first view
+     * their files are read ahead in the background, that makes the first view fast without loading the documents
+     */
+    const KConfigGroup generalGroup(KSharedConfig::openConfig(), "General");
+    const bool lazy = generalGroup.readEntry("Lazy Session Restore", false);
+    const bool prefetch = generalGroup.readEntry("Prefetch Lazy Session Documents", true);
+
+    /**
+     * read the files to load now in parallel, the documents load them one after the other from the cache
+     * the first document exists already, just load it
+     * untitled documents have nothing to load later
+     */
+    QList<QUrl> urls;
+    for (unsigned int i = 0; i < count; i++) {
+        urls.append(QUrl(KConfigGroup(config, QString::fromLatin1("Document %1").arg(i)).readEntry("URL", QString())));
+    }
+    QList<QUrl> prefetchUrls;
+    for (unsigned int i = 0; i < count; i++) {
+        if (!lazy || i == 0 || urls.at(i).isEmpty()) {
+            prefetchUrls.append(urls.at(i));
+        }
+    }
+    KateFilePrefetcher prefetcher(prefetchUrls);
+
     m_documentStillToRestore = count;
     m_openingErrors.clear();
     for (unsigned int i = 0; i < count; i++) {
         KConfigGroup cg(config, QString::fromLatin1("Document %1").arg(i));
         KTextEditor::Document *doc = 0;
 
+        const QUrl &url = urls.at(i);
+        if (lazy && i > 0 && !url.isEmpty()) {
+            KateDocumentInfo docInfo;
+            docInfo.placeholderUrl = url;
+            doc = createDoc(docInfo);
+
+            KConfigGroup placeholderGroup(&m_placeholderConfig, QString::number((qptrdiff)doc));
+            cg.copyTo(&placeholderGroup);
+
+            if (--m_documentStillToRestore == 0) {
+                QTimer::singleShot(0, this, SLOT(showRestoreErrors()));
+            }
+
+            progress.setValue(i);
+            continue;
+        }
+
         if (i == 0) {
             doc = m_docList.first();
         } else {
@@ -453,10 +818,23 @@ void KateDocManager::restoreDocumentList(KConfig *config)
         connect(doc, SIGNAL(completed()), this, SLOT(documentOpened()));
         connect(doc, SIGNAL(canceled(QString)), this, SLOT(documentOpened()));
 
+        prefetcher.waitFor(url);
         doc->readSessionConfig(cg);
 
         progress.setValue(i);
     }
+
+    if (prefetch && !m_placeholders.isEmpty()) {
+        QList<QUrl> placeholderUrls;
+        foreach(KTextEditor::Document * placeholder, m_placeholders) {
+            placeholderUrls.append(m_docInfos.value(placeholder)->placeholderUrl);
+        }
+        delete m_placeholderPrefetcher;
+        m_placeholderPrefetcher = new KateFilePrefetcher(placeholderUrls, true);
+    }
+
+    KateTrace::counter(QStringLiteral("documents restored"), count);
+    KateTrace::counter(QStringLiteral("documents placeholders"), m_placeholders.size());
 }
 
 void KateDocManager::slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTextEditor::ModificationInterface::ModifiedOnDiskReason reason)
@@ -468,6 +846,33 @@ void KateDocManager::slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTex
     }
 }
 
+void KateDocManager::importMetaInfos()
+{
+    /**
+     * only once: the new store is empty and the old file is still around
+     */
+    if (m_metaInfos.count() > 0) {
+        return;
+    }
+
+    const QString oldFile = QStandardPaths::locate(QStandardPaths::GenericConfigLocation, QStringLiteral("katemetainfos"));
+    if (oldFile.isEmpty()) {
+        return;
+    }
+
+    KConfig oldMetaInfos(oldFile, KConfig::SimpleConfig);
+    foreach(const QString & group, oldMetaInfos.groupList()) {
+        const KConfigGroup urlGroup(&oldMetaInfos, group);
+        KateMetaInfoStore::Entries entries = urlGroup.entryMap();
+        entries.remove(QStringLiteral("Time"));
+
+        const QDateTime time = urlGroup.readEntry("Time", QDateTime::currentDateTimeUtc());
+        m_metaInfos.put(group, entries, qMax(qint64(1), time.toMSecsSinceEpoch() / 1000));
+    }
+
+    m_metaInfos.flush();
+}
+
 /**
  * Load file and file's meta-information if the MD5 didn't change since last time.
  */
@@ -477,28 +882,40 @@ bool KateDocManager::loadMetaInfos(KTextEditor::Document *doc, const QUrl &url)
         return false;
     }
 
-    if (!m_metaInfos.hasGroup(url.toDisplayString())) {
+    const QString key = url.toDisplayString();
+    if (!m_metaInfos.contains(key)) {
         return false;
     }
 
-    const QByteArray checksum = doc->checksum().toHex();
+    /**
+     * unchanged file => infos are valid, no need to look at the content
+     * else compare the checksum, if the document has one already
+     */
+    const KateMetaInfoStore::Entries entries = m_metaInfos.entries(key);
+    const QString fileKey = metaInfoFileKey(url);
+    const bool fileUnchanged = !fileKey.isEmpty() && fileKey == entries.value(QStringLiteral("FileKey"));
+    const QByteArray checksum = fileUnchanged ? QByteArray() : doc->checksum().toHex();
     bool ok = true;
-    if (!checksum.isEmpty()) {
-        KConfigGroup urlGroup(&m_metaInfos, url.toDisplayString());
-        const QString old_checksum = urlGroup.readEntry("Checksum");
+    if (fileUnchanged || !checksum.isEmpty()) {
+        if (fileUnchanged || QString::fromLatin1(checksum) == entries.value(QStringLiteral("Checksum"))) {
+            /**
+             * the document reads its session config from a KConfigGroup, provide one in memory
+             */
+            KConfig config(QString(), KConfig::SimpleConfig);
+            KConfigGroup urlGroup(&config, key);
+            for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+                urlGroup.writeEntry(it.key(), it.value());
+            }
 
-        if (QString::fromLatin1(checksum) == old_checksum) {
             QSet<QString> flags;
             if (documentInfo(doc)->openedByUser) {
                 flags << QStringLiteral ("SkipEncoding");
             }
             doc->readSessionConfig(urlGroup, flags);
         } else {
-            urlGroup.deleteGroup();
+            m_metaInfos.remove(key);
             ok = false;
         }
-
-        m_metaInfos.sync();
     }
 
     return ok && doc->url() == url;
@@ -519,8 +936,8 @@ void KateDocManager::saveMetaInfos(const QList<KTextEditor::Document *> &documen
 
     /**
      * store meta info for all non-modified documents which have some checksum
+     * the store batches the writes, no need to sync here
      */
-    const QDateTime now = QDateTime::currentDateTimeUtc();
     foreach(KTextEditor::Document * doc, documents) {
         /**
          * skip modified docs
@@ -529,27 +946,44 @@ void KateDocManager::saveMetaInfos(const QList<KTextEditor::Document *> &documen
             continue;
         }
 
-        const QByteArray checksum = doc->checksum().toHex();
-        if (!checksum.isEmpty()) {
+        /**
+         * file unchanged since the infos got stored => reuse their checksum, hashing big files is expensive
+         */
+        const QString key = doc->url().toString();
 
-            /**
-             * write the group with checksum and time
-             */
-            KConfigGroup urlGroup(&m_metaInfos, doc->url().toString());
-            urlGroup.writeEntry("Checksum", QString::fromLatin1(checksum));
-            urlGroup.writeEntry("Time", now);
+        /**
+         * changed on disk and not reloaded: the file key would describe the new file, the checksum the old content
+         * store no key, the checksum alone rejects the infos for the new content
+         */
+        const KateDocumentInfo *info = documentInfo(doc);
+        const QString fileKey = (info && info->modifiedOnDisc) ? QString() : metaInfoFileKey(doc->url());
+        QString checksum;
+        if (!fileKey.isEmpty() && m_metaInfos.contains(key)) {
+            const KateMetaInfoStore::Entries entries = m_metaInfos.entries(key);
+            if (fileKey == entries.value(QStringLiteral("FileKey"))) {
+                checksum = entries.value(QStringLiteral("Checksum"));
+            }
+        }
+        if (checksum.isEmpty()) {
+            checksum = QString::fromLatin1(doc->checksum().toHex());
+        }
+
+        if (!checksum.isEmpty()) {
 
             /**
-             * write document session config
+             * collect checksum, file key and document session config via a KConfigGroup in memory
              */
+            KConfig config(QString(), KConfig::SimpleConfig);
+            KConfigGroup urlGroup(&config, key);
+            urlGroup.writeEntry("Checksum", checksum);
+            if (!fileKey.isEmpty()) {
+                urlGroup.writeEntry("FileKey", fileKey);
+            }
             doc->writeSessionConfig(urlGroup);
+
+            m_metaInfos.put(key, urlGroup.entryMap());
         }
     }
-
-    /**
-     * sync to not loose data
-     */
-    m_metaInfos.sync();
 }
 
 void KateDocManager::slotModChanged(KTextEditor::Document *doc)
@@ -561,8 +995,43 @@ void KateDocManager::slotModChanged(KTextEditor::Document *doc)
 
 void KateDocManager::slotModChanged1(KTextEditor::Document *doc)
 {
-    QMetaObject::invokeMethod(KateApp::self()->activeKateMainWindow(), "queueModifiedOnDisc",
-                                  Qt::QueuedConnection, Q_ARG(KTextEditor::Document *, doc));
+    // wait for the burst to end, but not forever
+    if (m_modOnDiskPending.isEmpty()) {
+        m_modOnDiskBatchAge.start();
+    }
+    m_modOnDiskPending.insert(doc);
+    if (m_modOnDiskBatchAge.elapsed() < ModOnDiskMaxDelay) {
+        m_modOnDiskTimer.start();
+    }
+}
+
+void KateDocManager::flushModifiedOnDisc()
+{
+    const bool mayWait = m_modOnDiskBatchAge.elapsed() < ModOnDiskMaxDelay;
+    QVector<KTextEditor::Document *> docs;
+    foreach(KTextEditor::Document * doc, m_docList) {
+        if (!m_modOnDiskPending.contains(doc)) {
+            continue;
+        }
+
+        // deleted and already back, e.g. rewritten by a checkout: the creation is reported soon, wait for it
+        KateDocumentInfo *info = m_docInfos.value(doc);
+        if (mayWait && info->modifiedOnDisc && info->modifiedOnDiscReason == KTextEditor::ModificationInterface::OnDiskDeleted
+                && doc->url().isLocalFile() && QFileInfo::exists(doc->url().toLocalFile())) {
+            continue;
+        }
+
+        docs.append(doc);
+        m_modOnDiskPending.remove(doc);
+    }
+
+    if (!m_modOnDiskPending.isEmpty()) {
+        m_modOnDiskTimer.start();
+    }
+
+    if (!docs.isEmpty() && KateApp::self()->activeKateMainWindow()) {
+        KateApp::self()->activeKateMainWindow()->queueModifiedOnDisc(docs);
+    }
 }
 
 void KateDocManager::documentOpened()
@@ -23,6 +23,7 @@
 #include <ktexteditor/document.h>
 #include <ktexteditor/editor.h>
 #include <ktexteditor/modificationinterface.h>
+#include <ktexteditor/view.h>
 
 #include <QList>
 #include <QObject>
@@ -30,11 +31,20 @@
 #include <QHash>
 #include <QMap>
 #include <QPair>
+#include <QPointer>
+#include <QSet>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QUrl>
+#include <QProgressDialog>
 
 #include <KConfig>
 
+#include "katemetainfostore.h"
+
 class KateMainWindow;
+class KateFilePrefetcher;
 
 class KateDocumentInfo
 {
@@ -54,6 +64,11 @@ public:
 
     bool openedByUser;
     bool openSuccess;
+
+    /**
+     * url a placeholder document will load, empty for loaded documents
+     */
+    QUrl placeholderUrl;
 };
 
 class KateDocManager : public QObject
@@ -68,13 +83,53 @@ public:
 
     KateDocumentInfo *documentInfo(KTextEditor::Document *doc);
 
-    /** Returns the documentNumber of the doc with url URL or -1 if no such doc is found */
+    /**
+     * Is this document a placeholder of a lazy session restore?
+     * Placeholders have no content yet, it is loaded on first view creation.
+     * @param doc document to check
+     * @return true if the document is not loaded yet
+     */
+    bool isPlaceholder(KTextEditor::Document *doc) const;
+
+    /**
+     * Url of the document, for placeholders the url they will load.
+     * @param doc document
+     * @return document url
+     */
+    QUrl documentUrl(KTextEditor::Document *doc) const;
+
+    /**
+     * Name of the document, for placeholders derived from the url they will load.
+     * @param doc document
+     * @return document name
+     */
+    QString documentName(KTextEditor::Document *doc) const;
+
+    /**
+     * Load the content of a placeholder document.
+     * Does nothing for documents that are loaded already.
+     * @param doc document to load
+     */
+    void loadPlaceholder(KTextEditor::Document *doc);
+
+    /**
+     * Find the document with the given url.
+     * Non-empty urls are looked up via hash, this is used by openUrl and KTextEditor::Application::findUrl.
+     * @param url url to search for, will be normalized
+     * @return document with this url or 0 if no such doc is found
+     */
     KTextEditor::Document *findDocument(const QUrl &url) const;
 
     const QList<KTextEditor::Document *> &documentList() const {
         return m_docList;
     }
 
+    /**
+     * All documents except placeholders, the list plugins get via KTextEditor::Application.
+     * @return loaded documents
+     */
+    QList<KTextEditor::Document *> loadedDocumentList() const;
+
     KTextEditor::Document *openUrl(const QUrl &,
                                    const QString &encoding = QString(),
                                    bool isTempFile = false,
@@ -109,18 +164,19 @@ public:
     }
     inline void setDaysMetaInfos(int i) {
         m_daysMetaInfos = i;
+        m_metaInfos.setMaxAge(i);
     }
 
 public Q_SLOTS:
     /**
-     * saves all documents that has at least one view.
-     * documents with no views are ignored :P
+     * saves all modified documents.
+     * done in time slices with progress, many documents don't block the ui
      */
     void saveAll();
 
     /**
-     * reloads all documents that has at least one view.
-     * documents with no views are ignored :P
+     * reloads all documents that are not modified on disk, prompts for the others.
+     * the files are read in parallel, the reloads are done in time slices with progress
      */
     void reloadAll();
 
@@ -197,16 +253,87 @@ private Q_SLOTS:
     void slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTextEditor::ModificationInterface::ModifiedOnDiskReason reason);
     void slotModChanged(KTextEditor::Document *doc);
     void slotModChanged1(KTextEditor::Document *doc);
+    void slotUrlChanged(KTextEditor::Document *doc);
+    void slotSessionConfigChanged(KTextEditor::Document *doc);
+    void slotViewCreated(KTextEditor::Document *doc, KTextEditor::View *view);
+    void slotViewFocusOut(KTextEditor::View *view);
+    void flushModifiedOnDisc();
+    void processBulkSlice();
 
     void showRestoreErrors();
 private:
+    /**
+     * (re)insert the document into the url hash with its current url
+     */
+    void indexDocument(KTextEditor::Document *doc);
+
+    /**
+     * remove the document from the url hash
+     */
+    void unindexDocument(KTextEditor::Document *doc);
+
+    void importMetaInfos();
     bool loadMetaInfos(KTextEditor::Document *doc, const QUrl &url);
     void saveMetaInfos(const QList<KTextEditor::Document *> &docs);
 
+    /**
+     * start a bulk reload or save of the given documents, see processBulkSlice()
+     */
+    void startBulk(bool reload, const QList<KTextEditor::Document *> &docs);
+
     QList<KTextEditor::Document *> m_docList;
     QHash<KTextEditor::Document *, KateDocumentInfo *> m_docInfos;
 
-    KConfig m_metaInfos;
+    /**
+     * normalized url => documents with this url, untitled documents are not contained
+     * plus the reverse mapping, to be able to remove the old entry on url changes
+     */
+    QMultiHash<QUrl, KTextEditor::Document *> m_docsByUrl;
+    QHash<KTextEditor::Document *, QUrl> m_docUrls;
+
+    KateMetaInfoStore m_metaInfos;
+
+    /**
+     * session config of placeholder documents, one group per document
+     * placeholders in restore order, their files are read into the page cache
+     * in the background, the documents stay unloaded until first shown
+     */
+    KConfig m_placeholderConfig;
+    QList<KTextEditor::Document *> m_placeholders;
+    KateFilePrefetcher *m_placeholderPrefetcher;
+
+    /**
+     * session config of each document as written last time, one group per document
+     * plus the documents that changed since then, only those get serialized again
+     */
+    KConfig m_sessionConfigCache;
+    QSet<KTextEditor::Document *> m_sessionConfigDirty;
+
+    /**
+     * documents with changed modified on disk state, handed to the main window in one batch
+     * once no more changes came in for a moment, e.g. after a checkout touched many files
+     */
+    QSet<KTextEditor::Document *> m_modOnDiskPending;
+    QTimer m_modOnDiskTimer;
+    QElapsedTimer m_modOnDiskBatchAge;
+
+    /**
+     * running bulk reload or save: documents still to do, done one slice per event loop round
+     */
+    QList<KTextEditor::Document *> m_bulkDocs;
+    bool m_bulkRunning;
+    bool m_bulkReload;
+    int m_bulkDone;
+    KateFilePrefetcher *m_bulkPrefetcher;
+    QPointer<QProgressDialog> m_bulkProgress;
+    QTimer m_bulkTimer;
+
+    /**
+     * requests that came in while a bulk operation was running, true for reload
+     * started in order once it is done, each kind at most once
+     */
+    QList<bool> m_bulkQueue;
+
     bool m_saveMetaInfos;
     int m_daysMetaInfos;
 
@@ -0,0 +1,133 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katefileprefetcher.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QMutex>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+namespace
+{
+/**
+ * read in chunks of this size, the data is thrown away
+ */
+const qint64 ChunkSize = 1 << 20;
+
+/**
+ * prefetching a single file makes no sense, just load it
+ */
+const int MinFiles = 2;
+}
+
+/**
+ * files still to read, guarded by the mutex
+ */
+struct KateFilePrefetcherState {
+    QMutex mutex;
+    QWaitCondition done;
+    QSet<QString> pending;
+    QAtomicInt cancel;
+};
+
+namespace
+{
+class ReadJob : public QRunnable
+{
+public:
+    ReadJob(const QSharedPointer<KateFilePrefetcherState> &state, const QString &fileName)
+        : m_state(state)
+        , m_fileName(fileName)
+    {
+    }
+
+    void run()
+    {
+        if (!m_state->cancel.load()) {
+            QFile file(m_fileName);
+            if (file.open(QIODevice::ReadOnly)) {
+                QByteArray buffer(ChunkSize, Qt::Uninitialized);
+                while (!m_state->cancel.load() && file.read(buffer.data(), ChunkSize) > 0) {
+                }
+            }
+        }
+
+        QMutexLocker locker(&m_state->mutex);
+        m_state->pending.remove(m_fileName);
+        m_state->done.wakeAll();
+    }
+
+private:
+    const QSharedPointer<KateFilePrefetcherState> m_state;
+    const QString m_fileName;
+};
+}
+
+KateFilePrefetcher::KateFilePrefetcher(const QList<QUrl> &urls, bool background)
+    : m_state(new KateFilePrefetcherState())
+{
+    /**
+     * keep the order of the urls, callers wait for them in that order
+     */
+    QStringList fileNames;
+    QSet<QString> pending;
+    for (const QUrl &url : urls) {
+        if (url.isLocalFile()) {
+            const QString fileName = url.toLocalFile();
+            if (!pending.contains(fileName)) {
+                pending.insert(fileName);
+                fileNames.append(fileName);
+            }
+        }
+    }
+
+    if (fileNames.size() < MinFiles) {
+        return;
+    }
+
+    /**
+     * register all files before the first job can finish
+     */
+    m_state->pending = pending;
+    const int priority = background ? -1 : 0;
+    for (const QString &fileName : fileNames) {
+        QThreadPool::globalInstance()->start(new ReadJob(m_state, fileName), priority);
+    }
+}
+
+KateFilePrefetcher::~KateFilePrefetcher()
+{
+    m_state->cancel.store(1);
+}
+
+void KateFilePrefetcher::waitFor(const QUrl &url)
+{
+    if (!url.isLocalFile()) {
+        return;
+    }
+
+    const QString fileName = url.toLocalFile();
+    QMutexLocker locker(&m_state->mutex);
+    while (m_state->pending.contains(fileName)) {
+        m_state->done.wait(&m_state->mutex);
+    }
+}
@@ -0,0 +1,65 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_FILE_PREFETCHER_H
+#define KATE_FILE_PREFETCHER_H
+
+#include <QList>
+#include <QSharedPointer>
+#include <QUrl>
+
+struct KateFilePrefetcherState;
+
+/**
+ * Reads local files in parallel on the global thread pool, to have them in
+ * the page cache once the documents load them one after the other on the
+ * GUI thread. Used when opening many files at once, e.g. session restore.
+ *
+ * Non-local urls are ignored. Destructing the prefetcher cancels all reads
+ * that did not start yet, running reads finish in the background.
+ */
+class KateFilePrefetcher
+{
+public:
+    /**
+     * Construct prefetcher, starts reading the files.
+     * @param urls urls to prefetch
+     * @param background read behind all other jobs of the pool, nobody waits for these files soon
+     */
+    explicit KateFilePrefetcher(const QList<QUrl> &urls, bool background = false);
+
+    /**
+     * Destruct prefetcher, cancels pending reads.
+     */
+    ~KateFilePrefetcher();
+
+    /**
+     * Block until the read of the given url is done.
+     * Returns at once for urls that are not prefetched.
+     * @param url url to wait for
+     */
+    void waitFor(const QUrl &url);
+
+private:
+    /**
+     * state shared with the read jobs, they may outlive us
+     */
+    QSharedPointer<KateFilePrefetcherState> m_state;
+};
+
+#endif
@@ -34,7 +34,9 @@
 #include "katesessionmanager.h"
 #include "kateviewspace.h"
 #include "katequickopen.h"
+#include "katequickopenindex.h"
 #include "kateupdatedisabler.h"
+#include "katetrace.h"
 #include "katedebug.h"
 
 #include <KActionMenu>
@@ -108,6 +110,8 @@ KateMainWindow::KateMainWindow(KConfig *sconfig, const QString &sgroup)
     , m_modignore(false)
     , m_wrapper(new KTextEditor::MainWindow(this))
 {
+    KateTraceScope trace("KateMainWindow::KateMainWindow");
+
     /**
      * we don't want any flicker here
      */
@@ -364,6 +368,7 @@ void KateMainWindow::setupActions()
     connect(m_viewManager, SIGNAL(viewChanged(KTextEditor::View*)), this, SLOT(slotWindowActivated()));
     connect(m_viewManager, SIGNAL(viewChanged(KTextEditor::View*)), this, SLOT(slotUpdateOpenWith()));
     connect(m_viewManager, SIGNAL(viewChanged(KTextEditor::View*)), this, SLOT(slotUpdateBottomViewBar()));
+    connect(m_viewManager, SIGNAL(viewChanged(KTextEditor::View*)), KateApp::self()->quickOpenIndex(), SLOT(slotViewChanged(KTextEditor::View*)));
 
     // re-route signals to our wrapper
     connect(m_viewManager, SIGNAL(viewChanged(KTextEditor::View*)), m_wrapper, SIGNAL(viewChanged(KTextEditor::View*)));
@@ -1024,7 +1029,6 @@ void KateMainWindow::saveWindowConfig(const KConfigGroup &_config)
     saveMainWindowSettings(config);
     KWindowConfig::saveWindowSize(windowHandle(), config);
     config.writeEntry("WindowState", int(((KParts::MainWindow *)this)->windowState()));
-    config.sync();
 }
 
 void KateMainWindow::restoreWindowConfig(const KConfigGroup &config)
@@ -1054,29 +1058,34 @@ void KateMainWindow::slotUpdateBottomViewBar()
     }
 }
 
-void KateMainWindow::queueModifiedOnDisc(KTextEditor::Document *doc)
+void KateMainWindow::queueModifiedOnDisc(const QVector<KTextEditor::Document *> &docs)
 {
     if (!m_modNotification) {
         return;
     }
-    KateDocumentInfo *docInfo = KateApp::self()->documentManager()->documentInfo(doc);
-    if (!docInfo) {
+
+    if (s_modOnHdDialog != 0) {
+        foreach(KTextEditor::Document * doc, docs) {
+            s_modOnHdDialog->addDocument(doc);
+        }
         return;
     }
-    bool modOnDisk = (uint)docInfo->modifiedOnDisc;
 
-    if (s_modOnHdDialog == 0 && modOnDisk) {
-        DocVector list;
-        list.append(doc);
+    DocVector list;
+    foreach(KTextEditor::Document * doc, docs) {
+        KateDocumentInfo *docInfo = KateApp::self()->documentManager()->documentInfo(doc);
+        if (docInfo && docInfo->modifiedOnDisc) {
+            list.append(doc);
+        }
+    }
 
+    if (!list.isEmpty()) {
         s_modOnHdDialog = new KateMwModOnHdDialog(list, this);
         m_modignore = true;
         KWindowSystem::setOnAllDesktops(s_modOnHdDialog->winId(), true);
         s_modOnHdDialog->exec();
         delete s_modOnHdDialog; // s_modOnHdDialog is set to 0 in destructor of KateMwModOnHdDialog (jowenn!!!)
         m_modignore = false;
-    } else if (s_modOnHdDialog != 0) {
-        s_modOnHdDialog->addDocument(doc);
     }
 }
 
@@ -34,6 +34,7 @@
 #include <QEvent>
 #include <QDropEvent>
 #include <QVBoxLayout>
+#include <QVector>
 #include <QModelIndex>
 #include <QHash>
 #include <QStackedWidget>
@@ -160,7 +161,13 @@ private:
 public Q_SLOTS:
     void slotFileClose();
     void slotFileQuit();
-    void queueModifiedOnDisc(KTextEditor::Document *doc);
+
+    /**
+     * handle documents whose modified on disk state changed,
+     * one prompt for all of them, or added to the prompt already shown
+     * @param docs documents to handle
+     */
+    void queueModifiedOnDisc(const QVector<KTextEditor::Document *> &docs);
 
     void slotFocusPrevTab();
     void slotFocusNextTab();
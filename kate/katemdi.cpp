@@ -804,6 +804,13 @@ ToolView *MainWindow::createToolView(KTextEditor::Plugin *plugin, const QString
         pos = (KMultiTabBar::KMultiTabBarPosition) cg.readEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Position").arg(identifier), int(pos));
     }
 
+    // created after the restore, but the session knows it
+    const bool pending = !m_restoreConfig && m_pendingToolViews.contains(identifier);
+    const PendingToolView state = m_pendingToolViews.take(identifier);
+    if (pending) {
+        pos = (KMultiTabBar::KMultiTabBarPosition) state.position;
+    }
+
     ToolView *v  = m_sidebars[pos]->addWidget(icon, text, 0);
     v->id = identifier;
     v->plugin = plugin;
@@ -814,6 +821,13 @@ ToolView *MainWindow::createToolView(KTextEditor::Plugin *plugin, const QString
     // register for menu stuff
     m_guiClient->registerToolView(v);
 
+    if (pending) {
+        v->persistent = state.persistent;
+        if (state.visible) {
+            showToolView(v);
+        }
+    }
+
     return v;
 }
 
@@ -822,6 +836,16 @@ ToolView *MainWindow::toolView(const QString &identifier) const
     return m_idToWidget[identifier];
 }
 
+bool MainWindow::hasVisibleToolView(KTextEditor::Plugin *plugin) const
+{
+    foreach(ToolView *tv, m_toolviews) {
+        if (tv->plugin == plugin && tv->toolVisible()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void MainWindow::toolViewDeleted(ToolView *widget)
 {
     if (!widget) {
@@ -973,11 +997,34 @@ void MainWindow::finishRestore()
         return;
     }
 
+    m_pendingToolViews.clear();
+
     if (m_restoreConfig->hasGroup(m_restoreGroup)) {
         // apply all settings, like toolbar pos and more ;)
         KConfigGroup cg(m_restoreConfig, m_restoreGroup);
         applyMainWindowSettings(cg);
 
+        // remember the toolviews that don't exist yet, their plugins might be loaded later
+        const QString prefix = QStringLiteral("Kate-MDI-ToolView-");
+        const QString suffix = QStringLiteral("-Position");
+        foreach(const QString & key, cg.keyList()) {
+            if (!key.startsWith(prefix) || !key.endsWith(suffix) || key.endsWith(QStringLiteral("-Sidebar-Position"))) {
+                continue;
+            }
+
+            const QString id = key.mid(prefix.size(), key.size() - prefix.size() - suffix.size());
+            if (m_idToWidget.contains(id)) {
+                continue;
+            }
+
+            PendingToolView state;
+            state.position = qBound(0, cg.readEntry(key, 0), 3);
+            state.sidebarPosition = cg.readEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Sidebar-Position").arg(id), 0);
+            state.visible = cg.readEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Visible").arg(id), false);
+            state.persistent = cg.readEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Persistent").arg(id), false);
+            m_pendingToolViews.insert(id, state);
+        }
+
         // reshuffle toolviews only if needed
         for (int i = 0; i < m_toolviews.size(); ++i) {
             KMultiTabBar::KMultiTabBarPosition newPos = (KMultiTabBar::KMultiTabBarPosition) cg.readEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Position").arg(m_toolviews[i]->id), int(m_toolviews[i]->sidebar()->position()));
@@ -1046,6 +1093,14 @@ void MainWindow::saveSession(KConfigGroup &config)
     for (unsigned int i = 0; i < 4; ++i) {
         m_sidebars[i]->saveSession(config);
     }
+
+    // keep the state of toolviews whose plugins are not loaded yet
+    for (auto it = m_pendingToolViews.constBegin(); it != m_pendingToolViews.constEnd(); ++it) {
+        config.writeEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Position").arg(it.key()), it->position);
+        config.writeEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Sidebar-Position").arg(it.key()), it->sidebarPosition);
+        config.writeEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Visible").arg(it.key()), it->visible);
+        config.writeEntry(QString::fromLatin1("Kate-MDI-ToolView-%1-Persistent").arg(it.key()), it->persistent);
+    }
 }
 
 //END MAIN WINDOW
@@ -29,6 +29,7 @@
 #include <KXMLGUIClient>
 #include <KToggleAction>
 
+#include <QHash>
 #include <QMap>
 #include <QSplitter>
 #include <QPixmap>
@@ -302,6 +303,13 @@ public:
      */
     ToolView *toolView(const QString &identifier) const;
 
+    /**
+     * is any toolview of the given plugin visible?
+     * @param plugin plugin to check
+     * @return true if the plugin shows a toolview
+     */
+    bool hasVisibleToolView(KTextEditor::Plugin *plugin) const;
+
     /**
      * set the toolview's tabbar style.
      * @param style the tabbar style.
@@ -445,6 +453,22 @@ private:
      */
     QString m_restoreGroup;
 
+    /**
+     * stored state of a toolview that did not exist yet at finishRestore()
+     */
+    struct PendingToolView {
+        int position;
+        int sidebarPosition;
+        bool visible;
+        bool persistent;
+    };
+
+    /**
+     * toolviews of the restored session created later, e.g. by deferred plugins:
+     * their state is applied on creation and written back on save until then
+     */
+    QHash<QString, PendingToolView> m_pendingToolViews;
+
     /**
      * out guiclient
      */
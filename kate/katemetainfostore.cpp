@@ -0,0 +1,311 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katemetainfostore.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+
+namespace
+{
+/**
+ * file header
+ */
+const quint32 Magic = 0x4b4d4946;
+const quint32 Version = 1;
+
+/**
+ * record kinds
+ */
+const quint8 PutRecord = 1;
+const quint8 RemoveRecord = 2;
+
+/**
+ * compact once the log has that many records more than keys
+ */
+const int CompactSlack = 1024;
+
+/**
+ * batch writes of this many milliseconds
+ */
+const int FlushDelay = 2000;
+
+qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+/**
+ * stream with the version used for the log
+ */
+void setupStream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+}
+
+QByteArray header()
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    setupStream(stream);
+    stream << Magic << Version;
+    return data;
+}
+
+/**
+ * appends records to the log or replaces it, runs on the writer thread
+ */
+class WriteJob : public QRunnable
+{
+public:
+    WriteJob(const QString &fileName, const QByteArray &data, bool replace)
+        : m_fileName(fileName)
+        , m_data(data)
+        , m_replace(replace)
+    {
+    }
+
+    void run()
+    {
+        QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+
+        /**
+         * compaction: replace atomically, data has the header
+         */
+        if (m_replace) {
+            QSaveFile file(m_fileName);
+            if (file.open(QIODevice::WriteOnly)) {
+                file.write(m_data);
+                file.commit();
+            }
+            return;
+        }
+
+        QFile file(m_fileName);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            if (file.size() == 0) {
+                file.write(header());
+            }
+            file.write(m_data);
+        }
+    }
+
+private:
+    const QString m_fileName;
+    const QByteArray m_data;
+    const bool m_replace;
+};
+}
+
+KateMetaInfoStore::KateMetaInfoStore(const QString &fileName)
+    : m_fileName(fileName)
+    , m_pendingRecords(0)
+    , m_logRecords(0)
+    , m_maxAge(0)
+    , m_expiryChecked(false)
+{
+    m_writer.setMaxThreadCount(1);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushDelay);
+    QObject::connect(&m_flushTimer, &QTimer::timeout, &m_flushTimer, [this]() {
+        flush();
+    });
+
+    load();
+}
+
+KateMetaInfoStore::~KateMetaInfoStore()
+{
+    sync();
+}
+
+void KateMetaInfoStore::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    setupStream(stream);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != Magic || version != Version) {
+        /**
+         * torn or foreign header: appends behind it would never be read, start a new log
+         */
+        file.close();
+        compact();
+        return;
+    }
+
+    /**
+     * replay the log, a broken tail from a crash ends it
+     */
+    bool broken = false;
+    while (!stream.atEnd()) {
+        quint8 kind = 0;
+        QString key;
+        qint64 time = 0;
+        stream >> kind >> key >> time;
+
+        if (kind == PutRecord) {
+            Record record;
+            record.time = time;
+            stream >> record.entries;
+            if (stream.status() != QDataStream::Ok) {
+                broken = true;
+                break;
+            }
+            m_records.insert(key, record);
+        } else if (kind == RemoveRecord && stream.status() == QDataStream::Ok) {
+            m_records.remove(key);
+        } else {
+            broken = true;
+            break;
+        }
+
+        ++m_logRecords;
+    }
+
+    /**
+     * rewrite a broken log right away, appends behind the broken tail would be lost on the next load
+     */
+    file.close();
+    if (broken) {
+        compact();
+    }
+}
+
+void KateMetaInfoStore::put(const QString &key, const Entries &entries, qint64 time)
+{
+    Record record;
+    record.time = time ? time : now();
+    record.entries = entries;
+    m_records.insert(key, record);
+
+    QDataStream stream(&m_pending, QIODevice::WriteOnly | QIODevice::Append);
+    setupStream(stream);
+    stream << PutRecord << key << record.time << entries;
+    ++m_pendingRecords;
+    ++m_logRecords;
+
+    m_flushTimer.start();
+}
+
+void KateMetaInfoStore::remove(const QString &key)
+{
+    if (!m_records.remove(key)) {
+        return;
+    }
+
+    QDataStream stream(&m_pending, QIODevice::WriteOnly | QIODevice::Append);
+    setupStream(stream);
+    stream << RemoveRecord << key << now();
+    ++m_pendingRecords;
+    ++m_logRecords;
+
+    m_flushTimer.start();
+}
+
+void KateMetaInfoStore::setMaxAge(int days)
+{
+    if (days != m_maxAge) {
+        m_maxAge = days;
+        m_expiryChecked = false;
+    }
+}
+
+bool KateMetaInfoStore::isExpired(const Record &record, qint64 now) const
+{
+    return m_maxAge > 0 && (now - record.time) > qint64(m_maxAge) * 24 * 3600;
+}
+
+void KateMetaInfoStore::flush()
+{
+    m_flushTimer.stop();
+
+    /**
+     * check once per run for expired records, triggers a compaction
+     */
+    bool expired = false;
+    if (!m_expiryChecked) {
+        m_expiryChecked = true;
+        const qint64 current = now();
+        for (auto it = m_records.constBegin(); it != m_records.constEnd() && !expired; ++it) {
+            expired = isExpired(it.value(), current);
+        }
+    }
+
+    if (expired || m_logRecords > m_records.size() * 2 + CompactSlack) {
+        compact();
+        return;
+    }
+
+    if (m_pendingRecords == 0) {
+        return;
+    }
+
+    m_writer.start(new WriteJob(m_fileName, m_pending, false));
+    m_pending.clear();
+    m_pendingRecords = 0;
+}
+
+void KateMetaInfoStore::sync()
+{
+    flush();
+    m_writer.waitForDone();
+}
+
+void KateMetaInfoStore::compact()
+{
+    /**
+     * forget expired records
+     */
+    const qint64 current = now();
+    for (auto it = m_records.begin(); it != m_records.end();) {
+        if (isExpired(it.value(), current)) {
+            it = m_records.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    /**
+     * snapshot of all records, written in the background
+     * the writer runs jobs in order, pending appends are contained
+     */
+    QByteArray data = header();
+    QDataStream stream(&data, QIODevice::WriteOnly | QIODevice::Append);
+    setupStream(stream);
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        stream << PutRecord << it.key() << it->time << it->entries;
+    }
+
+    m_writer.start(new WriteJob(m_fileName, data, true));
+    m_pending.clear();
+    m_pendingRecords = 0;
+    m_logRecords = m_records.size();
+}
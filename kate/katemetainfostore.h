@@ -0,0 +1,185 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_META_INFO_STORE_H
+#define KATE_META_INFO_STORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "kateprivate_export.h"
+
+/**
+ * Persistent per-file meta information, e.g. cursor, bookmarks and highlighting.
+ *
+ * All records are kept in a hash, the file on disk is an append-only log
+ * of put and remove records that gets replayed on load. Writes are batched
+ * and done in the background, in order, by one writer thread. Once the log
+ * has grown much longer than the number of files it describes or contains
+ * expired records, it is compacted into one record per file.
+ *
+ * Log format: QDataStream, magic and version, then per record the kind
+ * (put or remove), key, time (seconds since epoch) and for puts the entries.
+ */
+class KATE_TESTS_EXPORT KateMetaInfoStore
+{
+public:
+    /**
+     * Meta information of one file, key => value as written to KConfig.
+     */
+    typedef QMap<QString, QString> Entries;
+
+    /**
+     * Construct store, loads the given log file if it exists.
+     * @param fileName log file, created on first write
+     */
+    explicit KateMetaInfoStore(const QString &fileName);
+
+    /**
+     * Destruct store, writes pending records and waits for the writer.
+     */
+    ~KateMetaInfoStore();
+
+    /**
+     * Is there meta information for this key?
+     * @param key key, usually the url of a file
+     * @return true if known
+     */
+    bool contains(const QString &key) const {
+        return m_records.contains(key);
+    }
+
+    /**
+     * Meta information for a key.
+     * @param key key, usually the url of a file
+     * @return entries, empty for unknown keys
+     */
+    Entries entries(const QString &key) const {
+        return m_records.value(key).entries;
+    }
+
+    /**
+     * Time of the last put for a key.
+     * @param key key, usually the url of a file
+     * @return time in seconds since epoch, 0 for unknown keys
+     */
+    qint64 time(const QString &key) const {
+        return m_records.value(key).time;
+    }
+
+    /**
+     * Number of keys.
+     * @return key count
+     */
+    int count() const {
+        return m_records.size();
+    }
+
+    /**
+     * Store meta information, replaces the old one.
+     * @param key key, usually the url of a file
+     * @param entries entries to store
+     * @param time time of the change in seconds since epoch, 0 for now
+     */
+    void put(const QString &key, const Entries &entries, qint64 time = 0);
+
+    /**
+     * Forget meta information.
+     * @param key key, usually the url of a file
+     */
+    void remove(const QString &key);
+
+    /**
+     * Set after how many days without put records expire on compaction.
+     * @param days maximal age, 0 to keep records forever
+     */
+    void setMaxAge(int days);
+
+    /**
+     * Hand pending records to the writer now, compact if needed.
+     */
+    void flush();
+
+    /**
+     * Flush and block until everything is written.
+     */
+    void sync();
+
+private:
+    struct Record {
+        Record()
+            : time(0)
+        {
+        }
+
+        qint64 time;
+        Entries entries;
+    };
+
+    void load();
+    bool isExpired(const Record &record, qint64 now) const;
+    void compact();
+
+private:
+    /**
+     * log file name
+     */
+    const QString m_fileName;
+
+    /**
+     * state of all keys
+     */
+    QHash<QString, Record> m_records;
+
+    /**
+     * serialized records not yet handed to the writer, count of them
+     */
+    QByteArray m_pending;
+    int m_pendingRecords;
+
+    /**
+     * number of records in the log, including pending ones
+     */
+    int m_logRecords;
+
+    /**
+     * maximal age in days, 0 for no expiry
+     */
+    int m_maxAge;
+
+    /**
+     * was the log checked for expired records in this run?
+     */
+    bool m_expiryChecked;
+
+    /**
+     * batches writes
+     */
+    QTimer m_flushTimer;
+
+    /**
+     * one thread, writes happen in order
+     */
+    QThreadPool m_writer;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "kateapp.h"
 #include "katedocmanager.h"
 #include "katemainwindow.h"
+#include "katefileprefetcher.h"
 
 #include <KMessageBox>
 #include <KProcess>
@@ -179,6 +180,18 @@ void KateMwModOnHdDialog::handleSelected(int action)
     // don't alter the treewidget via addDocument, we modify it here!
     m_blockAddDocument = true;
 
+    // reloading many documents: read the files in parallel first
+    QList<QUrl> reloadUrls;
+    if (action == Reload) {
+        for (QTreeWidgetItemIterator it(twDocuments); *it; ++it) {
+            KateDocItem *item = (KateDocItem *) * it;
+            if (item->checkState(0) == Qt::Checked) {
+                reloadUrls.append(item->document->url());
+            }
+        }
+    }
+    KateFilePrefetcher prefetcher(reloadUrls);
+
     // collect all items we can remove
     QList<QTreeWidgetItem *> itemsToDelete;
     for (QTreeWidgetItemIterator it(twDocuments); *it; ++it) {
@@ -202,6 +215,7 @@ void KateMwModOnHdDialog::handleSelected(int action)
                 break;
 
             case Reload:
+                prefetcher.waitFor(item->document->url());
                 item->document->documentReload();
                 break;
 
@@ -25,25 +25,133 @@
 #include "kateapp.h"
 #include "katemainwindow.h"
 #include "katedebug.h"
+#include "katetrace.h"
 
 #include <KConfig>
 #include <KConfigGroup>
 #include <KPluginFactory>
 #include <KPluginLoader>
 
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
 
 #include <ktexteditor/sessionconfiginterface.h>
 
+namespace
+{
+/**
+ * name of a per plugin trace scope, only built while tracing
+ * saveName() stats the plugin file
+ */
+QString traceName(const char *what, const KatePluginInfo &info)
+{
+    return KateTrace::isEnabled() ? QString::fromLatin1(what) + QLatin1Char(' ') + info.saveName() : QString();
+}
+
+/**
+ * plugin metadata cache format version, bump on changes
+ */
+const quint32 PluginCacheVersion = 1;
+
+/**
+ * Key of the plugin metadata cache: all plugin directories with their
+ * modification time and all files in them with size and modification time.
+ * Installing, updating or removing plugins changes it.
+ */
+QByteArray pluginCacheKey()
+{
+    QByteArray key = QByteArray(KATE_VERSION) + ' ' + qVersion() + '\n';
+    foreach(const QString & libraryPath, QCoreApplication::libraryPaths()) {
+        const QFileInfo dir(libraryPath + QStringLiteral("/ktexteditor"));
+        if (!dir.isDir()) {
+            continue;
+        }
+
+        key += QFile::encodeName(dir.absoluteFilePath()) + ' ' + QByteArray::number(dir.lastModified().toMSecsSinceEpoch()) + '\n';
+        foreach(const QFileInfo & file, QDir(dir.absoluteFilePath()).entryInfoList(QDir::Files, QDir::Name)) {
+            key += QFile::encodeName(file.fileName()) + ' ' + QByteArray::number(file.size()) + ' ' + QByteArray::number(file.lastModified().toMSecsSinceEpoch()) + '\n';
+        }
+    }
+    return key;
+}
+
+/**
+ * read cached plugin metadata, false if the cache is missing or outdated
+ */
+bool readPluginCache(const QString &fileName, const QByteArray &key, QVector<KPluginMetaData> &plugins)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 version = 0;
+    QByteArray cachedKey;
+    stream >> version >> cachedKey;
+    if (version != PluginCacheVersion || cachedKey != key) {
+        return false;
+    }
+
+    quint32 count = 0;
+    stream >> count;
+    QVector<KPluginMetaData> result;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString pluginFile;
+        QByteArray json;
+        stream >> pluginFile >> json;
+        result.append(KPluginMetaData(QJsonDocument::fromJson(json).object(), pluginFile));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    plugins = result;
+    return true;
+}
+
+void writePluginCache(const QString &fileName, const QByteArray &key, const QVector<KPluginMetaData> &plugins)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << PluginCacheVersion << key << quint32(plugins.size());
+    foreach(const KPluginMetaData & plugin, plugins) {
+        stream << plugin.fileName() << QJsonDocument(plugin.rawData()).toJson(QJsonDocument::Compact);
+    }
+    file.commit();
+}
+}
+
 QString KatePluginInfo::saveName() const
 {
     return QFileInfo(metaData.fileName()).baseName();
 }
 
 KatePluginManager::KatePluginManager(QObject *parent) : QObject(parent)
+    , m_deferredConfig(QString(), KConfig::SimpleConfig)
 {
     setupPluginList();
+
+    // deferred plugins are loaded one per tick, to keep the ui responsive
+    m_deferredTimer.setInterval(50);
+    connect(&m_deferredTimer, SIGNAL(timeout()), this, SLOT(loadNextDeferredPlugin()));
 }
 
 KatePluginManager::~KatePluginManager()
@@ -56,10 +164,17 @@ void KatePluginManager::setupPluginList()
 {
     /**
      * get all KTextEditor/Plugins
+     * scanning needs to open all plugins, use the cache if nothing changed
      */
-    const QVector<KPluginMetaData> plugins = KPluginLoader::findPlugins(QStringLiteral("ktexteditor"), [](const KPluginMetaData & md) {
-            return md.serviceTypes().contains(QStringLiteral("KTextEditor/Plugin"));
-        });
+    const QString cacheFile = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/pluginmetadata");
+    const QByteArray cacheKey = pluginCacheKey();
+    QVector<KPluginMetaData> plugins;
+    if (!readPluginCache(cacheFile, cacheKey, plugins)) {
+        plugins = KPluginLoader::findPlugins(QStringLiteral("ktexteditor"), [](const KPluginMetaData & md) {
+                return md.serviceTypes().contains(QStringLiteral("KTextEditor/Plugin"));
+            });
+        writePluginCache(cacheFile, cacheKey, plugins);
+    }
 
     /**
      * move them to our internal data structure
@@ -99,6 +214,8 @@ void KatePluginManager::setupPluginList()
 
 void KatePluginManager::loadConfig(KConfig *config)
 {
+    KateTraceScope trace("KatePluginManager::loadConfig");
+
     // first: unload the plugins
     unloadAllPlugins();
 
@@ -116,9 +233,37 @@ void KatePluginManager::loadConfig(KConfig *config)
 
     /**
      * load plugins
+     * the ones that showed no toolview last time are queued and loaded after startup
      */
+    QSet<QString> deferred;
+    if (config) {
+        const KConfigGroup deferredGroup(config, QStringLiteral("Kate Deferred Plugins"));
+        for (int i = 0; i < m_pluginList.size(); ++i) {
+            if (deferredGroup.readEntry(m_pluginList[i].saveName(), false)) {
+                deferred.insert(m_pluginList[i].saveName());
+            }
+        }
+    }
+
     for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
+        if (it->load && deferred.contains(it->saveName())) {
+            const QStringList groups = QStringList()
+                                       << QString::fromLatin1("Plugin:%1:").arg(it->saveName())
+                                       << QString::fromLatin1("Plugin:%1:MainWindow:0").arg(it->saveName());
+            foreach(const QString & group, groups) {
+                if (config->hasGroup(group)) {
+                    KConfigGroup stash(&m_deferredConfig, group);
+                    KConfigGroup(config, group).copyTo(&stash);
+                }
+            }
+
+            m_deferredPlugins.append(&(*it));
+            continue;
+        }
+
         if (it->load) {
+            KateTraceScope pluginTrace(traceName("plugin", *it));
+
             /**
              * load plugin + trigger update of GUI for already existing main windows
              */
@@ -132,6 +277,59 @@ void KatePluginManager::loadConfig(KConfig *config)
             }
         }
     }
+
+    if (!m_deferredPlugins.isEmpty()) {
+        m_deferredTimer.start();
+    }
+}
+
+void KatePluginManager::loadNextDeferredPlugin()
+{
+    if (m_deferredPlugins.isEmpty()) {
+        m_deferredTimer.stop();
+        return;
+    }
+
+    loadDeferredPlugin(m_deferredPlugins.first());
+}
+
+void KatePluginManager::loadDeferredPlugin(KatePluginInfo *item)
+{
+    m_deferredPlugins.removeOne(item);
+    if (m_deferredPlugins.isEmpty()) {
+        m_deferredTimer.stop();
+    }
+
+    KateTraceScope trace(traceName("deferred plugin", *item));
+
+    /**
+     * like loadConfig does it, but with the stashed session config
+     */
+    const QString pluginGroup = QString::fromLatin1("Plugin:%1:").arg(item->saveName());
+    const QString viewGroup = QString::fromLatin1("Plugin:%1:MainWindow:0").arg(item->saveName());
+    if (loadPlugin(item)) {
+        for (int i = 0; i < KateApp::self()->mainWindowsCount(); i++) {
+            enablePluginGUI(item, KateApp::self()->mainWindow(i), &m_deferredConfig);
+        }
+
+        if (auto interface = qobject_cast<KTextEditor::SessionConfigInterface *> (item->plugin)) {
+            KConfigGroup group(&m_deferredConfig, pluginGroup);
+            interface->readSessionConfig(group);
+        }
+    }
+
+    m_deferredConfig.deleteGroup(pluginGroup);
+    m_deferredConfig.deleteGroup(viewGroup);
+}
+
+void KatePluginManager::clearDeferredPlugins()
+{
+    m_deferredTimer.stop();
+    foreach(KatePluginInfo *item, m_deferredPlugins) {
+        m_deferredConfig.deleteGroup(QString::fromLatin1("Plugin:%1:").arg(item->saveName()));
+        m_deferredConfig.deleteGroup(QString::fromLatin1("Plugin:%1:MainWindow:0").arg(item->saveName()));
+    }
+    m_deferredPlugins.clear();
 }
 
 void KatePluginManager::writeConfig(KConfig *config)
@@ -139,11 +337,35 @@ void KatePluginManager::writeConfig(KConfig *config)
     Q_ASSERT(config);
 
     KConfigGroup cg = KConfigGroup(config, QStringLiteral("Kate Plugins"));
-    foreach(const KatePluginInfo & plugin, m_pluginList) {
+    KConfigGroup deferredGroup(config, QStringLiteral("Kate Deferred Plugins"));
+    for (int i = 0; i < m_pluginList.size(); ++i) {
+        const KatePluginInfo &plugin = m_pluginList.at(i);
         QString saveName = plugin.saveName();
 
         cg.writeEntry(saveName, plugin.load);
 
+        // not loaded yet? pass on the stashed config, stays deferred
+        if (m_deferredPlugins.contains(&m_pluginList[i])) {
+            const QStringList groups = QStringList()
+                                       << QString::fromLatin1("Plugin:%1:").arg(saveName)
+                                       << QString::fromLatin1("Plugin:%1:MainWindow:0").arg(saveName);
+            foreach(const QString & group, groups) {
+                if (m_deferredConfig.hasGroup(group)) {
+                    KConfigGroup target(config, group);
+                    KConfigGroup(&m_deferredConfig, group).copyTo(&target);
+                }
+            }
+            deferredGroup.writeEntry(saveName, true);
+            continue;
+        }
+
+        // plugins showing no toolview can be loaded after startup next time
+        bool deferrable = plugin.plugin != nullptr;
+        for (int w = 0; deferrable && w < KateApp::self()->mainWindowsCount(); ++w) {
+            deferrable = !KateApp::self()->mainWindow(w)->hasVisibleToolView(plugin.plugin);
+        }
+        deferredGroup.writeEntry(saveName, deferrable);
+
         // save config
         if (auto interface = qobject_cast<KTextEditor::SessionConfigInterface *> (plugin.plugin)) {
             KConfigGroup group(config, QString::fromLatin1("Plugin:%1:").arg(saveName));
@@ -154,6 +376,8 @@ void KatePluginManager::writeConfig(KConfig *config)
 
 void KatePluginManager::unloadAllPlugins()
 {
+    clearDeferredPlugins();
+
     for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
         if (it->plugin) {
             unloadPlugin(&(*it));
@@ -195,6 +419,14 @@ bool KatePluginManager::loadPlugin(KatePluginInfo *item)
      */
     if (item->plugin) {
         emit KateApp::self()->wrapper()->pluginCreated(item->saveName(), item->plugin);
+
+        if (KateTrace::isEnabled()) {
+            int loaded = 0;
+            foreach(const KatePluginInfo & info, m_pluginList) {
+                loaded += info.plugin ? 1 : 0;
+            }
+            KateTrace::counter(QStringLiteral("plugins loaded"), loaded);
+        }
     }
 
     return item->plugin != nullptr;
@@ -202,6 +434,7 @@ bool KatePluginManager::loadPlugin(KatePluginInfo *item)
 
 void KatePluginManager::unloadPlugin(KatePluginInfo *item)
 {
+    m_deferredPlugins.removeOne(item);
     disablePluginGUI(item);
     delete item->plugin;
     KTextEditor::Plugin *plugin = item->plugin;
@@ -220,6 +453,8 @@ void KatePluginManager::enablePluginGUI(KatePluginInfo *item, KateMainWindow *wi
     // lookup if there is already a view for it..
     QObject *createdView = nullptr;
     if (!win->pluginViews().contains(item->plugin)) {
+        KateTraceScope trace(traceName("plugin view", *item));
+
         // create the view + try to correctly load shortcuts, if it's a GUI Client
         createdView = item->plugin->createView(win->wrapper());
         if (createdView) {
@@ -316,8 +551,13 @@ class KTextEditor::Plugin *KatePluginManager::loadPlugin(const QString &name, bo
 
     /**
      * load, bail out on error
+     * still in the deferred queue? load it now, with its session config
      */
-    loadPlugin(m_name2Plugin.value(name));
+    if (m_deferredPlugins.contains(m_name2Plugin.value(name))) {
+        loadDeferredPlugin(m_name2Plugin.value(name));
+    } else {
+        loadPlugin(m_name2Plugin.value(name));
+    }
     if (!m_name2Plugin.value(name)->plugin) {
         return 0;
     }
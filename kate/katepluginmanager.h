@@ -25,11 +25,13 @@
 #include <KTextEditor/Plugin>
 
 #include <KPluginMetaData>
+#include <KConfig>
 #include <KConfigBase>
 
 #include <QObject>
 #include <QList>
 #include <QMap>
+#include <QTimer>
 
 class KConfig;
 class KateMainWindow;
@@ -86,9 +88,25 @@ public:
     KTextEditor::Plugin *loadPlugin(const QString &name, bool permanent = true);
     void unloadPlugin(const QString &name, bool permanent = true);
 
+private Q_SLOTS:
+    /**
+     * load the next plugin of the deferred queue, one per timer tick
+     */
+    void loadNextDeferredPlugin();
+
 private:
     void setupPluginList();
 
+    /**
+     * load a plugin of the deferred queue, with the session config stashed for it
+     */
+    void loadDeferredPlugin(KatePluginInfo *item);
+
+    /**
+     * forget the deferred queue
+     */
+    void clearDeferredPlugins();
+
     /**
      * all known plugins
      */
@@ -99,6 +117,14 @@ private:
      * uses the info stored in the plugin list
      */
     QMap<QString, KatePluginInfo *> m_name2Plugin;
+
+    /**
+     * plugins without visible toolview in the last session are loaded after startup
+     * their session config is stashed in memory until then
+     */
+    QList<KatePluginInfo *> m_deferredPlugins;
+    KConfig m_deferredConfig;
+    QTimer m_deferredTimer;
 };
 
 #endif
@@ -18,6 +18,7 @@
 */
 
 #include "katequickopen.h"
+#include "katequickopenmodel.h"
 
 #include "katemainwindow.h"
 #include "kateviewmanager.h"
@@ -34,22 +35,13 @@
 #include <KLocalizedString>
 
 #include <QEvent>
-#include <QFileInfo>
-#include <QSortFilterProxyModel>
+#include <QHideEvent>
 #include <QCoreApplication>
-#include <QPointer>
-#include <QStandardItemModel>
 #include <QDesktopWidget>
 #include <QBoxLayout>
 #include <QLabel>
 #include <QTreeView>
 
-Q_DECLARE_METATYPE(QPointer<KTextEditor::Document>)
-
-static const int DocumentRole = Qt::UserRole + 1;
-static const int UrlRole = Qt::UserRole + 2;
-static const int SortFilterRole = Qt::UserRole + 3;
-
 KateQuickOpen::KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow)
     : QWidget(parent)
     , m_mainWindow(mainWindow)
@@ -69,23 +61,17 @@ KateQuickOpen::KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow)
     layout->addWidget(m_listView, 1);
     m_listView->setTextElideMode(Qt::ElideLeft);
 
-    m_base_model = new QStandardItemModel(0, 2, this);
+    m_listView->setUniformRowHeights(true);
 
-    m_model = new QSortFilterProxyModel(this);
-    m_model->setFilterRole(SortFilterRole);
-    m_model->setSortRole(SortFilterRole);
-    m_model->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    m_model->setSortCaseSensitivity(Qt::CaseInsensitive);
+    m_model = new KateQuickOpenModel(KateApp::self()->quickOpenIndex(), this);
 
-    connect(m_inputLine, &KLineEdit::textChanged, m_model, &QSortFilterProxyModel::setFilterWildcard);
+    connect(m_inputLine, &KLineEdit::textChanged, m_model, &KateQuickOpenModel::setFilterString);
     connect(m_inputLine, &KLineEdit::returnPressed, this, &KateQuickOpen::slotReturnPressed);
-    connect(m_model, &QSortFilterProxyModel::rowsInserted, this, &KateQuickOpen::reselectFirst);
-    connect(m_model, &QSortFilterProxyModel::rowsRemoved, this, &KateQuickOpen::reselectFirst);
+    connect(m_model, &KateQuickOpenModel::modelReset, this, &KateQuickOpen::reselectFirst);
 
     connect(m_listView, &QTreeView::activated, this, &KateQuickOpen::slotReturnPressed);
 
     m_listView->setModel(m_model);
-    m_model->setSourceModel(m_base_model);
 
     m_inputLine->installEventFilter(this);
     m_listView->installEventFilter(this);
@@ -136,6 +122,15 @@ bool KateQuickOpen::eventFilter(QObject *obj, QEvent *event)
     return QWidget::eventFilter(obj, event);
 }
 
+void KateQuickOpen::hideEvent(QHideEvent *event)
+{
+    /**
+     * no need to keep the model current while not shown
+     */
+    m_model->setActive(false);
+    QWidget::hideEvent(event);
+}
+
 void KateQuickOpen::reselectFirst()
 {
     QModelIndex index = m_model->index(0, 0);
@@ -145,131 +140,20 @@ void KateQuickOpen::reselectFirst()
 void KateQuickOpen::update()
 {
     /**
-     * new base mode creation
-     */
-    QStandardItemModel *base_model = new QStandardItemModel(0, 2, this);
-
-    /**
-     * remember local file names to avoid dupes with project files
-     */
-    QSet<QString> alreadySeenFiles;
-    QSet<KTextEditor::Document *> alreadySeenDocs;
-
-    /**
-     * get views in lru order
-     */
-    const QList<KTextEditor::View *> sortedViews(m_mainWindow->viewManager()->sortedViews());
-
-    /**
-     * now insert them in order
+     * documents of our views in lru order first, the shared index has all the rest
      */
-    QModelIndex idxToSelect;
-    int linecount = 0;
-    foreach (KTextEditor::View *view, sortedViews) {
-        KTextEditor::Document *doc = view->document();
-
-        if (alreadySeenDocs.contains(doc)) {
-            continue;
-        }
-
-        alreadySeenDocs.insert(doc);
-
-        //QStandardItem *item=new QStandardItem(i18n("%1: %2",doc->documentName(),doc->url().toString()));
-        QStandardItem *itemName = new QStandardItem(doc->documentName());
-
-        itemName->setData(qVariantFromValue(QPointer<KTextEditor::Document> (doc)), DocumentRole);
-        itemName->setData(QString::fromLatin1("%1: %2").arg(doc->documentName()).arg(doc->url().toString()), SortFilterRole);
-        itemName->setEditable(false);
-        QFont font = itemName->font();
-        font.setBold(true);
-        itemName->setFont(font);
-
-        QStandardItem *itemUrl = new QStandardItem(doc->url().toString());
-        itemUrl->setEditable(false);
-        base_model->setItem(linecount, 0, itemName);
-        base_model->setItem(linecount, 1, itemUrl);
-        linecount++;
-
-        if (!doc->url().isEmpty() && doc->url().isLocalFile()) {
-            alreadySeenFiles.insert(doc->url().toLocalFile());
-        }
-
-        // select second document, that is the last used (beside the active one)
-        if (linecount == 2) {
-            idxToSelect = itemName->index();
-        }
-    }
-
-    /**
-     * get all open documents
-     */
-    QList<KTextEditor::Document *> docs = KateApp::self()->documentManager()->documentList();
-    foreach(KTextEditor::Document * doc, docs) {
-        /**
-         * skip docs already open
-         */
-        if (alreadySeenDocs.contains(doc)) {
-            continue;
-        }
-
-        //QStandardItem *item=new QStandardItem(i18n("%1: %2",doc->documentName(),doc->url().toString()));
-        QStandardItem *itemName = new QStandardItem(doc->documentName());
-
-        itemName->setData(qVariantFromValue(QPointer<KTextEditor::Document> (doc)), DocumentRole);
-        itemName->setData(QString::fromLatin1("%1: %2").arg(doc->documentName()).arg(doc->url().toString()), SortFilterRole);
-        itemName->setEditable(false);
-        QFont font = itemName->font();
-        font.setBold(true);
-        itemName->setFont(font);
-
-        QStandardItem *itemUrl = new QStandardItem(doc->url().toString());
-        itemUrl->setEditable(false);
-        base_model->setItem(linecount, 0, itemName);
-        base_model->setItem(linecount, 1, itemUrl);
-        linecount++;
-
-        if (!doc->url().isEmpty() && doc->url().isLocalFile()) {
-            alreadySeenFiles.insert(doc->url().toLocalFile());
+    QList<KTextEditor::Document *> documents;
+    foreach (KTextEditor::View *view, m_mainWindow->viewManager()->sortedViews()) {
+        if (!documents.contains(view->document())) {
+            documents.append(view->document());
         }
     }
+    m_model->setDocumentOrder(documents);
+    m_model->setActive(true);
 
-    /**
-     * insert all project files, if any project around
-     */
-    if (QObject *projectView = m_mainWindow->pluginView(QStringLiteral("kateprojectplugin"))) {
-        QStringList projectFiles = projectView->property("projectFiles").toStringList();
-        foreach(const QString & file, projectFiles) {
-            /**
-             * skip files already open
-             */
-            if (alreadySeenFiles.contains(file)) {
-                continue;
-            }
-
-            QFileInfo fi(file);
-            QStandardItem *itemName = new QStandardItem(fi.fileName());
-
-            itemName->setData(qVariantFromValue(QUrl::fromLocalFile(file)), UrlRole);
-            itemName->setData(QString::fromLatin1("%1: %2").arg(fi.fileName()).arg(file), SortFilterRole);
-            itemName->setEditable(false);
-
-            QStandardItem *itemUrl = new QStandardItem(file);
-            itemUrl->setEditable(false);
-            base_model->setItem(linecount, 0, itemName);
-            base_model->setItem(linecount, 1, itemUrl);
-            linecount++;
-        }
-    }
-
-    /**
-     * swap models and kill old one
-     */
-    m_model->setSourceModel(base_model);
-    delete m_base_model;
-    m_base_model = base_model;
-
-    if (idxToSelect.isValid()) {
-        m_listView->setCurrentIndex(m_model->mapFromSource(idxToSelect));
+    // select second document, that is the last used (beside the active one)
+    if (m_inputLine->text().isEmpty() && documents.size() >= 2) {
+        m_listView->setCurrentIndex(m_model->index(1, 0));
     } else {
         reselectFirst();
     }
@@ -288,11 +172,11 @@ void KateQuickOpen::slotReturnPressed()
      */
     // our data is in column 0 (clicking on column 1 results in no data, therefore, create new index)
     const QModelIndex index = m_listView->model()->index(m_listView->currentIndex().row(), 0);
-    KTextEditor::Document *doc = index.data(DocumentRole).value<QPointer<KTextEditor::Document> >();
+    KTextEditor::Document *doc = index.data(KateQuickOpenModel::DocumentRole).value<QPointer<KTextEditor::Document> >();
     if (doc) {
         m_mainWindow->wrapper()->activateView(doc);
     } else {
-        QUrl url = index.data(UrlRole).value<QUrl>();
+        QUrl url = index.data(KateQuickOpenModel::UrlRole).value<QUrl>();
         if (!url.isEmpty()) {
             m_mainWindow->wrapper()->openUrl(url);
         }
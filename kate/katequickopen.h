@@ -23,11 +23,10 @@
 #include <QWidget>
 
 class KateMainWindow;
+class KateQuickOpenModel;
 class KLineEdit;
 
 class QModelIndex;
-class QStandardItemModel;
-class QSortFilterProxyModel;
 class QTreeView;
 
 class KateQuickOpen : public QWidget
@@ -37,12 +36,14 @@ public:
     KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow);
     /**
      * update state
-     * will fill model with current open documents, project documents, ...
+     * will order the open documents of our views first, the rest is
+     * kept current by the shared quick open index
      */
     void update();
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event);
+    void hideEvent(QHideEvent *event);
 
 private Q_SLOTS:
     void reselectFirst();
@@ -59,14 +60,9 @@ private:
     KLineEdit *m_inputLine;
 
     /**
-     * our model we search in
+     * our model we search in, filtered and ranked by fuzzy matching
      */
-    QStandardItemModel *m_base_model;
-
-    /**
-     * filtered model we search in
-     */
-    QSortFilterProxyModel *m_model;
+    KateQuickOpenModel *m_model;
 };
 
 #endif
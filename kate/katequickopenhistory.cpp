@@ -0,0 +1,234 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katequickopenhistory.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <cmath>
+
+namespace
+{
+/**
+ * after that many seconds a value counts half
+ */
+const double HalfLife = 7 * 24 * 3600;
+
+/**
+ * weights of the events
+ */
+const double OpenedWeight = 2.0;
+const double ActivatedWeight = 1.0;
+
+/**
+ * files below that value are dropped on compaction
+ */
+const double MinValue = 0.05;
+
+/**
+ * compact once the log has that many records more than files
+ */
+const int CompactSlack = 1024;
+
+qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+double decayed(double value, qint64 from, qint64 to)
+{
+    return (to <= from) ? value : value * std::exp2(-double(to - from) / HalfLife);
+}
+}
+
+KateQuickOpenHistory::KateQuickOpenHistory(const QString &fileName)
+    : m_fileName(fileName)
+    , m_log(fileName)
+    , m_logRecords(0)
+{
+    load();
+}
+
+KateQuickOpenHistory::~KateQuickOpenHistory()
+{
+    flush();
+    if (m_log.isOpen()) {
+        m_log.close();
+    }
+}
+
+void KateQuickOpenHistory::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    /**
+     * a crash while appending may leave a torn last line, appends would continue it
+     */
+    bool torn = false;
+    char last = 0;
+    if (file.size() > 0 && file.seek(file.size() - 1) && file.getChar(&last)) {
+        torn = (last != '\n');
+        file.seek(0);
+    }
+
+    /**
+     * replay the log, skip broken records
+     */
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    QString line;
+    while (!(line = stream.readLine()).isNull()) {
+        const QStringList parts = line.split(QLatin1Char('\t'));
+        if (parts.size() != 4 || parts.at(3).isEmpty()) {
+            continue;
+        }
+
+        bool timeOk = false;
+        bool valueOk = false;
+        const qint64 time = parts.at(0).toLongLong(&timeOk);
+        const double value = parts.at(2).toDouble(&valueOk);
+        if (timeOk && valueOk) {
+            apply(parts.at(3), value, time);
+            ++m_logRecords;
+        }
+    }
+    file.close();
+
+    if (torn || m_logRecords > m_records.size() * 2 + CompactSlack) {
+        compact();
+    }
+}
+
+void KateQuickOpenHistory::apply(const QString &path, double value, qint64 time)
+{
+    auto it = m_records.find(path);
+    if (it == m_records.end()) {
+        const Record record = { value, time };
+        m_records.insert(path, record);
+        return;
+    }
+
+    /**
+     * decay the older part to the newer time
+     */
+    if (time >= it->time) {
+        it->value = decayed(it->value, it->time, time) + value;
+        it->time = time;
+    } else {
+        it->value += decayed(value, time, it->time);
+    }
+}
+
+bool KateQuickOpenHistory::openLog()
+{
+    if (m_log.isOpen()) {
+        return true;
+    }
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    return m_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+void KateQuickOpenHistory::record(const QString &path, Event event, qint64 time)
+{
+    if (path.isEmpty() || path.contains(QLatin1Char('\n'))) {
+        return;
+    }
+
+    if (!time) {
+        time = now();
+    }
+
+    const double value = (event == Opened) ? OpenedWeight : ActivatedWeight;
+    apply(path, value, time);
+
+    /**
+     * buffer for the log, compact it from time to time
+     */
+    m_pending += QStringLiteral("%1\t%2\t%3\t%4\n").arg(time).arg((event == Opened) ? QLatin1Char('o') : QLatin1Char('a')).arg(value).arg(path).toUtf8();
+    ++m_logRecords;
+
+    if (m_logRecords > m_records.size() * 2 + CompactSlack) {
+        compact();
+    }
+}
+
+void KateQuickOpenHistory::flush()
+{
+    if (m_pending.isEmpty() || !openLog()) {
+        return;
+    }
+
+    m_log.write(m_pending);
+    m_log.flush();
+    m_pending.clear();
+}
+
+double KateQuickOpenHistory::frecency(const QString &path, qint64 time) const
+{
+    const auto it = m_records.constFind(path);
+    if (it == m_records.constEnd()) {
+        return 0;
+    }
+
+    return decayed(it->value, it->time, time ? time : now());
+}
+
+void KateQuickOpenHistory::compact()
+{
+    /**
+     * forget what decayed away
+     */
+    const qint64 current = now();
+    for (auto it = m_records.begin(); it != m_records.end();) {
+        if (decayed(it->value, it->time, current) < MinValue) {
+            it = m_records.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    /**
+     * write new log atomically, one record per file, this includes the pending ones
+     */
+    if (m_log.isOpen()) {
+        m_log.close();
+    }
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return;
+    }
+
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        file.write(QStringLiteral("%1\tc\t%2\t%3\n").arg(it->time).arg(it->value).arg(it.key()).toUtf8());
+    }
+
+    if (file.commit()) {
+        m_pending.clear();
+        m_logRecords = m_records.size();
+    }
+}
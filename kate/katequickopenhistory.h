@@ -0,0 +1,138 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_QUICK_OPEN_HISTORY_H
+#define KATE_QUICK_OPEN_HISTORY_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+#include "kateprivate_export.h"
+
+/**
+ * Persistent access history of files, used to rank quick open results.
+ *
+ * Each open or activation of a file adds a weight to its frecency, which
+ * decays exponentially over time. Events are buffered and appended to a log
+ * file on flush(), on load the log is replayed. Once the log has grown much longer than the
+ * number of files it describes, it is compacted into one record per file.
+ *
+ * Log format, one record per line: time (seconds since epoch), kind
+ * (o = opened, a = activated, c = compacted), value, path; separated by tabs.
+ */
+class KATE_TESTS_EXPORT KateQuickOpenHistory
+{
+public:
+    /**
+     * Kind of recorded event.
+     */
+    enum Event {
+        Opened,
+        Activated
+    };
+
+    /**
+     * Construct history, loads the given log file if it exists.
+     * @param fileName log file, created on first record
+     */
+    explicit KateQuickOpenHistory(const QString &fileName);
+
+    /**
+     * Destruct history, flushes the log.
+     */
+    ~KateQuickOpenHistory();
+
+    /**
+     * Record an event for a file.
+     * The event is only buffered, it is written to the log on flush().
+     * @param path local file path
+     * @param event kind of event
+     * @param time time of the event in seconds since epoch, 0 for now
+     */
+    void record(const QString &path, Event event, qint64 time = 0);
+
+    /**
+     * Frecency of a file.
+     * @param path local file path
+     * @param time time to compute the decayed value for, 0 for now
+     * @return frecency, 0 for unknown files
+     */
+    double frecency(const QString &path, qint64 time = 0) const;
+
+    /**
+     * Append all buffered events to the log.
+     */
+    void flush();
+
+    /**
+     * All files with history.
+     * @return known paths
+     */
+    QList<QString> paths() const {
+        return m_records.keys();
+    }
+
+    /**
+     * Rewrite the log with one record per file, forgetting files
+     * whose frecency decayed to nearly nothing.
+     */
+    void compact();
+
+private:
+    /**
+     * decayed value of one file at a given time
+     */
+    struct Record {
+        double value;
+        qint64 time;
+    };
+
+    void load();
+    void apply(const QString &path, double value, qint64 time);
+    bool openLog();
+
+private:
+    /**
+     * log file name
+     */
+    const QString m_fileName;
+
+    /**
+     * log opened for appending, if already needed
+     */
+    QFile m_log;
+
+    /**
+     * records not yet written to the log
+     */
+    QByteArray m_pending;
+
+    /**
+     * number of records in the log, including the pending ones
+     */
+    int m_logRecords;
+
+    /**
+     * state of all files
+     */
+    QHash<QString, Record> m_records;
+};
+
+#endif
@@ -0,0 +1,331 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katequickopenindex.h"
+#include "katedocmanager.h"
+
+#include <ktexteditor/application.h>
+#include <ktexteditor/plugin.h>
+#include <ktexteditor/view.h>
+
+#include <QStandardPaths>
+
+#include <cmath>
+
+namespace
+{
+/**
+ * open documents rank above project files with similar score
+ */
+const int OpenDocumentBonus = 48;
+
+/**
+ * purge removed entries once there are that many and they outnumber the live ones
+ */
+const int MinRemovedToCompact = 1024;
+
+/**
+ * bonus for frecently used files: HistoryBonusScale per doubling of the frecency, capped
+ */
+const int HistoryBonusScale = 24;
+const int MaxHistoryBonus = 96;
+
+/**
+ * history events are written to its log at most that often, in milliseconds
+ */
+const int HistoryFlushDelay = 10000;
+}
+
+KateQuickOpenIndex::KateQuickOpenIndex(KateDocManager *docManager, KTextEditor::Application *application)
+    : QObject()
+    , m_docManager(docManager)
+    , m_removedCount(0)
+    , m_history(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kate/quickopenhistory"))
+{
+    m_changedTimer.setSingleShot(true);
+    m_changedTimer.setInterval(0);
+    connect(&m_changedTimer, &QTimer::timeout, this, &KateQuickOpenIndex::slotEmitChanged);
+
+    m_historyFlushTimer.setSingleShot(true);
+    m_historyFlushTimer.setInterval(HistoryFlushDelay);
+    connect(&m_historyFlushTimer, &QTimer::timeout, this, &KateQuickOpenIndex::slotFlushHistory);
+
+    connect(docManager, &KateDocManager::documentCreated, this, &KateQuickOpenIndex::slotDocumentCreated);
+    connect(docManager, &KateDocManager::documentDeleted, this, &KateQuickOpenIndex::slotDocumentDeleted);
+    connect(application, &KTextEditor::Application::pluginCreated, this, &KateQuickOpenIndex::slotPluginCreated);
+    connect(application, &KTextEditor::Application::pluginDeleted, this, &KateQuickOpenIndex::slotPluginDeleted);
+
+    for (KTextEditor::Document *document : docManager->documentList()) {
+        slotDocumentCreated(document);
+    }
+}
+
+void KateQuickOpenIndex::slotDocumentCreated(KTextEditor::Document *document)
+{
+    connect(document, &KTextEditor::Document::documentNameChanged, this, &KateQuickOpenIndex::slotDocumentChanged);
+    connect(document, &KTextEditor::Document::documentUrlChanged, this, &KateQuickOpenIndex::slotDocumentUrlChanged);
+    addDocument(document);
+}
+
+void KateQuickOpenIndex::slotDocumentDeleted(KTextEditor::Document *document)
+{
+    /**
+     * pointer is dangling, only use it as key
+     */
+    removeDocument(document);
+}
+
+void KateQuickOpenIndex::slotDocumentChanged(KTextEditor::Document *document)
+{
+    /**
+     * the matcher text changes => new entry
+     */
+    removeDocument(document);
+    addDocument(document);
+}
+
+void KateQuickOpenIndex::slotDocumentUrlChanged(KTextEditor::Document *document)
+{
+    /**
+     * a document the user opened got a local file, session restore and
+     * placeholder loads don't count
+     */
+    const QUrl url = document->url();
+    const KateDocumentInfo *info = m_docManager->documentInfo(document);
+    if (url.isLocalFile() && info && info->openedByUser) {
+        recordHistory(url.toLocalFile(), KateQuickOpenHistory::Opened);
+    }
+
+    slotDocumentChanged(document);
+}
+
+void KateQuickOpenIndex::slotViewChanged(KTextEditor::View *view)
+{
+    if (!view || !view->document()->url().isLocalFile()) {
+        return;
+    }
+
+    /**
+     * no changed() here: only bonuses change, ids stay valid
+     */
+    const QString localFile = view->document()->url().toLocalFile();
+    recordHistory(localFile, KateQuickOpenHistory::Activated);
+    updateHistoryBonus(localFile);
+}
+
+void KateQuickOpenIndex::slotPluginCreated(const QString &name, KTextEditor::Plugin *plugin)
+{
+    if (name == QStringLiteral("kateprojectplugin")) {
+        connect(plugin, SIGNAL(projectFilesChanged(QString, QStringList)), this, SLOT(slotProjectFilesChanged(QString, QStringList)));
+    }
+}
+
+void KateQuickOpenIndex::slotPluginDeleted(const QString &name, KTextEditor::Plugin *)
+{
+    if (name == QStringLiteral("kateprojectplugin")) {
+        for (const QString &projectFileName : m_projectIds.keys()) {
+            removeProject(projectFileName);
+        }
+    }
+}
+
+void KateQuickOpenIndex::slotProjectFilesChanged(const QString &projectFileName, const QStringList &files)
+{
+    removeProject(projectFileName);
+
+    QVector<int> &ids = m_projectIds[projectFileName];
+    ids.reserve(files.size());
+    for (const QString &file : files) {
+        KateQuickOpenEntry entry;
+        entry.url = QUrl::fromLocalFile(file);
+        entry.fileName = file.mid(file.lastIndexOf(QLatin1Char('/')) + 1);
+        entry.filePath = file;
+        const int id = addEntry(entry, file);
+        ids.append(id);
+        m_projectFileIds.insert(file, id);
+        m_matcher.setBonus(id, historyBonus(file));
+
+        /**
+         * already open as document?
+         */
+        if (m_openLocalFiles.contains(file)) {
+            m_matcher.setEnabled(id, false);
+        }
+    }
+}
+
+void KateQuickOpenIndex::slotFlushHistory()
+{
+    m_history.flush();
+}
+
+void KateQuickOpenIndex::slotEmitChanged()
+{
+    if (m_removedCount >= MinRemovedToCompact && m_removedCount > m_entries.size() - m_removedCount) {
+        compact();
+    }
+
+    emit changed();
+}
+
+int KateQuickOpenIndex::addEntry(const KateQuickOpenEntry &entry, const QString &candidate)
+{
+    const int id = m_matcher.addCandidate(candidate);
+    Q_ASSERT(id == m_entries.size());
+    m_entries.append(entry);
+    m_removed.resize(m_entries.size());
+    m_changedTimer.start();
+    return id;
+}
+
+void KateQuickOpenIndex::removeEntry(int id)
+{
+    m_entries[id] = KateQuickOpenEntry();
+    m_matcher.setEnabled(id, false);
+    m_removed.setBit(id);
+    ++m_removedCount;
+    m_changedTimer.start();
+}
+
+void KateQuickOpenIndex::addDocument(KTextEditor::Document *document)
+{
+    const QUrl url = m_docManager->documentUrl(document);
+
+    KateQuickOpenEntry entry;
+    entry.document = document;
+    entry.fileName = m_docManager->documentName(document);
+    entry.filePath = url.toString();
+    const QString localFile = url.isLocalFile() ? url.toLocalFile() : QString();
+    const int id = addEntry(entry, !localFile.isEmpty() ? localFile : (entry.filePath.isEmpty() ? entry.fileName : entry.filePath));
+    m_matcher.setBonus(id, OpenDocumentBonus + historyBonus(localFile));
+    m_documentIds.insert(document, id);
+
+    /**
+     * hide project entries for this file while it is open
+     */
+    if (!localFile.isEmpty()) {
+        m_documentLocalFiles.insert(document, localFile);
+        m_localFileDocuments.insert(localFile, document);
+        if (++m_openLocalFiles[localFile] == 1) {
+            for (auto it = m_projectFileIds.constFind(localFile); it != m_projectFileIds.constEnd() && it.key() == localFile; ++it) {
+                m_matcher.setEnabled(it.value(), false);
+            }
+        }
+    }
+}
+
+void KateQuickOpenIndex::removeDocument(KTextEditor::Document *document)
+{
+    const auto it = m_documentIds.find(document);
+    if (it == m_documentIds.end()) {
+        return;
+    }
+    removeEntry(it.value());
+    m_documentIds.erase(it);
+
+    /**
+     * show project entries again, if this was the last document for that file
+     */
+    const QString localFile = m_documentLocalFiles.take(document);
+    m_localFileDocuments.remove(localFile, document);
+    if (!localFile.isEmpty() && --m_openLocalFiles[localFile] == 0) {
+        m_openLocalFiles.remove(localFile);
+        for (auto it = m_projectFileIds.constFind(localFile); it != m_projectFileIds.constEnd() && it.key() == localFile; ++it) {
+            m_matcher.setEnabled(it.value(), true);
+        }
+    }
+}
+
+void KateQuickOpenIndex::removeProject(const QString &projectFileName)
+{
+    const QVector<int> ids = m_projectIds.take(projectFileName);
+    for (int id : ids) {
+        m_projectFileIds.remove(m_entries.at(id).filePath, id);
+        removeEntry(id);
+    }
+}
+
+void KateQuickOpenIndex::compact()
+{
+    /**
+     * rebuild entries and matcher without the removed ones
+     */
+    const QVector<int> newIds = m_matcher.purge(m_removed);
+    QVector<KateQuickOpenEntry> entries;
+    entries.reserve(m_entries.size() - m_removedCount);
+    for (int id = 0; id < m_entries.size(); ++id) {
+        if (!m_removed.testBit(id)) {
+            entries.append(m_entries.at(id));
+        }
+    }
+
+    m_entries.swap(entries);
+    m_removed = QBitArray(m_entries.size());
+    m_removedCount = 0;
+
+    /**
+     * renumber all id mappings
+     */
+    for (auto it = m_documentIds.begin(); it != m_documentIds.end(); ++it) {
+        it.value() = newIds.at(it.value());
+    }
+    for (auto it = m_projectIds.begin(); it != m_projectIds.end(); ++it) {
+        for (int &id : it.value()) {
+            id = newIds.at(id);
+        }
+    }
+    for (auto it = m_projectFileIds.begin(); it != m_projectFileIds.end(); ++it) {
+        it.value() = newIds.at(it.value());
+    }
+
+    /**
+     * bonuses were computed at different times, let them decay alike
+     */
+    for (const QString &localFile : m_history.paths()) {
+        updateHistoryBonus(localFile);
+    }
+}
+
+void KateQuickOpenIndex::recordHistory(const QString &localFile, KateQuickOpenHistory::Event event)
+{
+    m_history.record(localFile, event);
+    if (!m_historyFlushTimer.isActive()) {
+        m_historyFlushTimer.start();
+    }
+}
+
+int KateQuickOpenIndex::historyBonus(const QString &localFile) const
+{
+    if (localFile.isEmpty()) {
+        return 0;
+    }
+
+    const double frecency = m_history.frecency(localFile);
+    return (frecency > 0) ? qMin(MaxHistoryBonus, int(HistoryBonusScale * std::log2(1 + frecency))) : 0;
+}
+
+void KateQuickOpenIndex::updateHistoryBonus(const QString &localFile)
+{
+    const int bonus = historyBonus(localFile);
+    for (auto it = m_localFileDocuments.constFind(localFile); it != m_localFileDocuments.constEnd() && it.key() == localFile; ++it) {
+        m_matcher.setBonus(m_documentIds.value(it.value()), OpenDocumentBonus + bonus);
+    }
+    for (auto it = m_projectFileIds.constFind(localFile); it != m_projectFileIds.constEnd() && it.key() == localFile; ++it) {
+        m_matcher.setBonus(it.value(), bonus);
+    }
+}
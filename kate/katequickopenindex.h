@@ -0,0 +1,215 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_QUICK_OPEN_INDEX_H
+#define KATE_QUICK_OPEN_INDEX_H
+
+#include "katequickopenhistory.h"
+#include "katequickopenmatcher.h"
+
+#include <ktexteditor/document.h>
+
+#include <QBitArray>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QUrl>
+
+class KateDocManager;
+
+namespace KTextEditor
+{
+class Application;
+class Plugin;
+class View;
+}
+
+/**
+ * One entry of quick open: open document or project file.
+ */
+struct KateQuickOpenEntry {
+    QPointer<KTextEditor::Document> document;
+    QUrl url;
+    QString fileName;
+    QString filePath;
+};
+
+Q_DECLARE_METATYPE(QPointer<KTextEditor::Document>)
+
+/**
+ * Application wide index of everything quick open can show:
+ * all open documents and the files of all open projects.
+ *
+ * The index is kept current incrementally via the signals of the document
+ * manager and the project plugin and is shared by all main windows.
+ * Entry ids are the candidate ids of the matcher. Removed entries are only
+ * disabled and get purged in batches, this may renumber all entries,
+ * users must refetch their ids on changed().
+ *
+ * Local files the user opens or activates are recorded in a persistent history,
+ * the frecency of a file raises the matcher bonus of its entries.
+ */
+class KateQuickOpenIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct index, picks up the already open documents.
+     * @param docManager document manager to track
+     * @param application application wrapper, used to track the project plugin
+     */
+    KateQuickOpenIndex(KateDocManager *docManager, KTextEditor::Application *application);
+
+    /**
+     * Matcher over all entries.
+     * @return matcher
+     */
+    const KateQuickOpenMatcher &matcher() const {
+        return m_matcher;
+    }
+
+    /**
+     * Access entry.
+     * @param id entry id
+     * @return entry
+     */
+    const KateQuickOpenEntry &entry(int id) const {
+        return m_entries.at(id);
+    }
+
+    /**
+     * Number of entries, including removed ones.
+     * @return entry count
+     */
+    int size() const {
+        return m_entries.size();
+    }
+
+    /**
+     * Entry id for an open document.
+     * @param document document to look up
+     * @return entry id, -1 if none
+     */
+    int documentId(KTextEditor::Document *document) const {
+        return m_documentIds.value(document, -1);
+    }
+
+public Q_SLOTS:
+    /**
+     * Record the activation of a view's document in the history.
+     * @param view newly active view, may be null
+     */
+    void slotViewChanged(KTextEditor::View *view);
+
+Q_SIGNALS:
+    /**
+     * Emitted once after a batch of changes.
+     * Entry ids might have changed.
+     */
+    void changed();
+
+private Q_SLOTS:
+    void slotDocumentCreated(KTextEditor::Document *document);
+    void slotDocumentDeleted(KTextEditor::Document *document);
+    void slotDocumentChanged(KTextEditor::Document *document);
+    void slotDocumentUrlChanged(KTextEditor::Document *document);
+    void slotPluginCreated(const QString &name, KTextEditor::Plugin *plugin);
+    void slotPluginDeleted(const QString &name, KTextEditor::Plugin *plugin);
+    void slotProjectFilesChanged(const QString &projectFileName, const QStringList &files);
+    void slotEmitChanged();
+    void slotFlushHistory();
+
+private:
+    int addEntry(const KateQuickOpenEntry &entry, const QString &candidate);
+    void removeEntry(int id);
+    void addDocument(KTextEditor::Document *document);
+    void removeDocument(KTextEditor::Document *document);
+    void removeProject(const QString &projectFileName);
+    void compact();
+    void recordHistory(const QString &localFile, KateQuickOpenHistory::Event event);
+    int historyBonus(const QString &localFile) const;
+    void updateHistoryBonus(const QString &localFile);
+
+private:
+    /**
+     * document manager, knows the urls of placeholder documents
+     */
+    KateDocManager *m_docManager;
+
+    /**
+     * all entries, indexed by id
+     */
+    QVector<KateQuickOpenEntry> m_entries;
+
+    /**
+     * removed entries, purged by compact()
+     */
+    QBitArray m_removed;
+    int m_removedCount;
+
+    /**
+     * matcher, candidate i belongs to entry i
+     */
+    KateQuickOpenMatcher m_matcher;
+
+    /**
+     * document => entry id and local file, if any
+     */
+    QHash<KTextEditor::Document *, int> m_documentIds;
+    QHash<KTextEditor::Document *, QString> m_documentLocalFiles;
+
+    /**
+     * local file => documents for it, to update bonuses without a scan
+     */
+    QMultiHash<QString, KTextEditor::Document *> m_localFileDocuments;
+
+    /**
+     * project file name => entry ids of its files
+     */
+    QHash<QString, QVector<int> > m_projectIds;
+
+    /**
+     * local file => entry ids of project files for it
+     */
+    QMultiHash<QString, int> m_projectFileIds;
+
+    /**
+     * local file => number of open documents for it,
+     * project entries of open files are disabled
+     */
+    QHash<QString, int> m_openLocalFiles;
+
+    /**
+     * coalesces changes into one changed() signal
+     */
+    QTimer m_changedTimer;
+
+    /**
+     * access history of local files
+     */
+    KateQuickOpenHistory m_history;
+
+    /**
+     * batches the writes of the history log
+     */
+    QTimer m_historyFlushTimer;
+};
+
+#endif
@@ -0,0 +1,384 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katequickopenmatcher.h"
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace
+{
+/**
+ * score parts, see KateQuickOpenMatcher::score()
+ */
+const int MatchScore = 16;
+const int ConsecutiveBonus = 16;
+const int BoundaryBonus = 24;
+const int FileNameBonus = 8;
+const int FileNameStartBonus = 32;
+const int FileNameOnlyBonus = 64;
+const int MaxGapPenalty = 8;
+
+/**
+ * below that many candidates, scoring in parallel does not pay off
+ */
+const int ChunkSize = 16384;
+
+inline char asciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+inline bool isSeparator(char c)
+{
+    return c == '/' || c == '\\' || c == '_' || c == '-' || c == '.' || c == ' ' || c == ':';
+}
+
+/**
+ * ordering of results: better score first, then lower id
+ */
+inline bool isBetter(const KateQuickOpenMatcher::Match &a, const KateQuickOpenMatcher::Match &b)
+{
+    return a.score > b.score || (a.score == b.score && a.id < b.id);
+}
+
+/**
+ * is pattern[k..] a subsequence of text[begin, end)?
+ */
+bool isSubsequence(const char *text, int begin, int end, const QByteArray &pattern, int k)
+{
+    const char *p = text + begin;
+    const char *const e = text + end;
+    for (; k < pattern.size(); ++k) {
+        p = static_cast<const char *>(memchr(p, pattern.at(k), e - p));
+        if (!p) {
+            return false;
+        }
+        ++p;
+    }
+    return true;
+}
+
+/**
+ * runs a function on the thread pool
+ */
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(const std::function<void()> &function)
+        : m_function(function)
+    {
+    }
+
+    void run()
+    {
+        m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+};
+
+/**
+ * pool for the match chunks, separate from the global pool: match() blocks
+ * until its chunks are done, they must not queue behind file reads or ctags jobs
+ */
+Q_GLOBAL_STATIC(QThreadPool, matchPool)
+}
+
+KateQuickOpenMatcher::KateQuickOpenMatcher()
+    : m_offsets(1, 0)
+{
+}
+
+void KateQuickOpenMatcher::clear()
+{
+    m_text.clear();
+    m_boundaries.clear();
+    m_offsets.clear();
+    m_offsets.append(0);
+    m_fileNameOffsets.clear();
+    m_enabled.clear();
+    m_bonus.clear();
+}
+
+void KateQuickOpenMatcher::setCandidates(const QStringList &paths)
+{
+    clear();
+    m_offsets.reserve(paths.size() + 1);
+    m_fileNameOffsets.reserve(paths.size());
+    m_bonus.reserve(paths.size());
+    for (const QString &path : paths) {
+        addCandidate(path);
+    }
+}
+
+int KateQuickOpenMatcher::addCandidate(const QString &path)
+{
+    const QByteArray bytes = path.toUtf8();
+    const int start = m_text.size();
+    m_text.reserve(start + bytes.size());
+    m_boundaries.resize((start + bytes.size() + 7) / 8);
+
+    /**
+     * lowercase and remember boundaries of the original spelling:
+     * start, after separators and lower => upper case changes
+     */
+    int fileNameStart = start;
+    char previous = '/';
+    for (int i = 0; i < bytes.size(); ++i) {
+        const char c = bytes.at(i);
+        const int pos = start + i;
+        const bool boundary = isSeparator(previous) || (previous >= 'a' && previous <= 'z' && c >= 'A' && c <= 'Z');
+        if (boundary) {
+            m_boundaries[pos >> 3] = char(m_boundaries.at(pos >> 3) | (1 << (pos & 7)));
+        } else {
+            m_boundaries[pos >> 3] = char(m_boundaries.at(pos >> 3) & ~(1 << (pos & 7)));
+        }
+        if (c == '/' || c == '\\') {
+            fileNameStart = pos + 1;
+        }
+        m_text.append(asciiLower(c));
+        previous = c;
+    }
+
+    m_fileNameOffsets.append(fileNameStart);
+    m_offsets.append(m_text.size());
+    m_bonus.append(0);
+
+    const int id = size() - 1;
+    m_enabled.resize(id + 1);
+    m_enabled.setBit(id);
+    return id;
+}
+
+QVector<int> KateQuickOpenMatcher::purge(const QBitArray &removed)
+{
+    QVector<int> newIds(size(), -1);
+    QByteArray text;
+    QByteArray boundaries;
+    QVector<int> offsets;
+    QVector<int> fileNameOffsets;
+    QBitArray enabled(size());
+    QVector<int> bonus;
+    text.reserve(m_text.size());
+    boundaries.reserve(m_boundaries.size());
+    offsets.append(0);
+
+    int newId = 0;
+    for (int id = 0; id < size(); ++id) {
+        if (removed.testBit(id)) {
+            continue;
+        }
+
+        /**
+         * copy bytes and boundary bits, bit positions shift
+         */
+        const int begin = m_offsets.at(id);
+        const int end = m_offsets.at(id + 1);
+        const int start = text.size();
+        text.append(m_text.constData() + begin, end - begin);
+        boundaries.resize((text.size() + 7) / 8);
+        for (int pos = begin; pos < end; ++pos) {
+            const int newPos = start + pos - begin;
+            if (isBoundary(pos)) {
+                boundaries[newPos >> 3] = char(boundaries.at(newPos >> 3) | (1 << (newPos & 7)));
+            } else {
+                boundaries[newPos >> 3] = char(boundaries.at(newPos >> 3) & ~(1 << (newPos & 7)));
+            }
+        }
+
+        offsets.append(text.size());
+        fileNameOffsets.append(start + m_fileNameOffsets.at(id) - begin);
+        enabled.setBit(newId, m_enabled.testBit(id));
+        bonus.append(m_bonus.at(id));
+        newIds[id] = newId++;
+    }
+    enabled.resize(newId);
+
+    m_text.swap(text);
+    m_boundaries.swap(boundaries);
+    m_offsets.swap(offsets);
+    m_fileNameOffsets.swap(fileNameOffsets);
+    m_enabled.swap(enabled);
+    m_bonus.swap(bonus);
+    return newIds;
+}
+
+QByteArray KateQuickOpenMatcher::preparePattern(const QString &pattern)
+{
+    QByteArray bytes = pattern.toUtf8();
+    for (int i = 0; i < bytes.size(); ++i) {
+        bytes[i] = asciiLower(bytes.at(i));
+    }
+    return bytes;
+}
+
+int KateQuickOpenMatcher::score(int id, const QByteArray &pattern) const
+{
+    const char *text = m_text.constData();
+    const int begin = m_offsets.at(id);
+    const int end = m_offsets.at(id + 1);
+    const int fileNameStart = m_fileNameOffsets.at(id);
+
+    /**
+     * cheap reject first, most candidates fail here
+     */
+    if (pattern.size() > end - begin || !isSubsequence(text, begin, end, pattern, 0)) {
+        return -1;
+    }
+
+    /**
+     * greedy matching from a start position, taking a later occurrence
+     * on a boundary if the rest of the pattern still fits behind it
+     */
+    auto scoreFrom = [&](int from) {
+        int score = 0;
+        int last = -2;
+        int pos = from;
+        for (int k = 0; k < pattern.size(); ++k) {
+            const char c = pattern.at(k);
+            int p = static_cast<const char *>(memchr(text + pos, c, end - pos)) - text;
+            if (p != last + 1 && !isBoundary(p)) {
+                for (int q = p + 1; q < end; ++q) {
+                    if (text[q] == c && isBoundary(q)) {
+                        if (isSubsequence(text, q + 1, end, pattern, k + 1)) {
+                            p = q;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            score += MatchScore;
+            if (p == last + 1) {
+                score += ConsecutiveBonus;
+            } else if (last >= 0) {
+                score -= qMin(p - last - 1, MaxGapPenalty);
+            }
+            if (isBoundary(p)) {
+                score += BoundaryBonus;
+            }
+            if (p >= fileNameStart) {
+                score += FileNameBonus;
+                if (p == fileNameStart) {
+                    score += FileNameStartBonus;
+                }
+            }
+
+            last = p;
+            pos = p + 1;
+        }
+        return score;
+    };
+
+    int result = scoreFrom(begin);
+
+    /**
+     * matching inside the file name alone is what the user wants most of the time
+     */
+    if (fileNameStart > begin && pattern.size() <= end - fileNameStart && isSubsequence(text, fileNameStart, end, pattern, 0)) {
+        result = qMax(result, scoreFrom(fileNameStart) + FileNameOnlyBonus);
+    }
+
+    /**
+     * shorter paths win ties, keep the score positive
+     */
+    return qMax(0, result - ((end - begin) >> 4));
+}
+
+QVector<KateQuickOpenMatcher::Match> KateQuickOpenMatcher::matchRange(int begin, int end, const QByteArray &pattern, int maxResults) const
+{
+    /**
+     * heap of the best results, worst one on top
+     */
+    QVector<Match> heap;
+    heap.reserve(qMin(maxResults, end - begin) + 1);
+    for (int id = begin; id < end; ++id) {
+        if (!m_enabled.testBit(id)) {
+            continue;
+        }
+
+        const int s = pattern.isEmpty() ? 0 : score(id, pattern);
+        if (s < 0) {
+            continue;
+        }
+
+        const Match match = { id, s + m_bonus.at(id) };
+        if (heap.size() < maxResults) {
+            heap.append(match);
+            std::push_heap(heap.begin(), heap.end(), isBetter);
+        } else if (isBetter(match, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), isBetter);
+            heap.back() = match;
+            std::push_heap(heap.begin(), heap.end(), isBetter);
+        }
+    }
+    return heap;
+}
+
+QVector<KateQuickOpenMatcher::Match> KateQuickOpenMatcher::match(const QString &pattern, int maxResults) const
+{
+    QVector<Match> results;
+    if (maxResults <= 0) {
+        return results;
+    }
+
+    /**
+     * score chunks in parallel, the calling thread does the first chunk itself
+     */
+    const QByteArray bytes = preparePattern(pattern);
+    const int chunks = qBound(1, size() / ChunkSize, QThread::idealThreadCount());
+    if (chunks == 1) {
+        results = matchRange(0, size(), bytes, maxResults);
+    } else {
+        QVector<QVector<Match> > chunkResults(chunks);
+        QSemaphore done;
+        const int chunkSize = (size() + chunks - 1) / chunks;
+        for (int chunk = 1; chunk < chunks; ++chunk) {
+            const int begin = chunk * chunkSize;
+            const int end = qMin(size(), begin + chunkSize);
+            QVector<Match> *result = &chunkResults[chunk];
+            matchPool()->start(new FunctionRunnable([this, begin, end, &bytes, maxResults, result, &done]() {
+                *result = matchRange(begin, end, bytes, maxResults);
+                done.release();
+            }));
+        }
+        chunkResults[0] = matchRange(0, chunkSize, bytes, maxResults);
+        done.acquire(chunks - 1);
+
+        for (const QVector<Match> &chunkResult : chunkResults) {
+            results += chunkResult;
+        }
+    }
+
+    /**
+     * merge: sort and cut
+     */
+    const int count = qMin(maxResults, results.size());
+    std::partial_sort(results.begin(), results.begin() + count, results.end(), isBetter);
+    results.resize(count);
+    return results;
+}
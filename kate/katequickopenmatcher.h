@@ -0,0 +1,195 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_QUICK_OPEN_MATCHER_H
+#define KATE_QUICK_OPEN_MATCHER_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "kateprivate_export.h"
+
+/**
+ * Fuzzy matching engine for quick open.
+ *
+ * Candidates are paths, stored as one ASCII-lowercased UTF-8 buffer plus
+ * a bitmap marking the word boundaries of the original spelling.
+ * A pattern matches a candidate if it is a subsequence of it, the score
+ * rewards matches on path segment and word boundaries, consecutive
+ * matches and matches inside the file name.
+ * Large candidate sets are scored in parallel chunks, only the best
+ * results are kept.
+ *
+ * Candidates can be appended and disabled, ids stay stable until clear() or purge().
+ * Each candidate carries a bonus that is added to its score.
+ */
+class KATE_TESTS_EXPORT KateQuickOpenMatcher
+{
+public:
+    /**
+     * One match: candidate id and score, higher is better.
+     */
+    struct Match {
+        int id;
+        int score;
+    };
+
+    KateQuickOpenMatcher();
+
+    /**
+     * Replace all candidates.
+     * The id of a candidate is its index in the list.
+     * @param paths candidate paths
+     */
+    void setCandidates(const QStringList &paths);
+
+    /**
+     * Remove all candidates.
+     */
+    void clear();
+
+    /**
+     * Append a candidate.
+     * @param path candidate path
+     * @return id of the new candidate
+     */
+    int addCandidate(const QString &path);
+
+    /**
+     * Drop candidates, the remaining ones get renumbered.
+     * @param removed bit set for each candidate to drop
+     * @return mapping old id => new id, -1 for dropped candidates
+     */
+    QVector<int> purge(const QBitArray &removed);
+
+    /**
+     * Enable or disable a candidate, disabled ones never match.
+     * @param id candidate id
+     * @param enabled new state
+     */
+    void setEnabled(int id, bool enabled) {
+        m_enabled.setBit(id, enabled);
+    }
+
+    /**
+     * Is the candidate enabled?
+     * @param id candidate id
+     * @return enabled state
+     */
+    bool isEnabled(int id) const {
+        return m_enabled.testBit(id);
+    }
+
+    /**
+     * Set the bonus added to the score of a candidate.
+     * @param id candidate id
+     * @param bonus bonus, may be negative
+     */
+    void setBonus(int id, int bonus) {
+        m_bonus[id] = bonus;
+    }
+
+    /**
+     * Bonus of a candidate.
+     * @param id candidate id
+     * @return bonus
+     */
+    int bonus(int id) const {
+        return m_bonus.at(id);
+    }
+
+    /**
+     * Number of candidates, including disabled ones.
+     * @return candidate count
+     */
+    int size() const {
+        return m_offsets.size() - 1;
+    }
+
+    /**
+     * Find the best matching candidates for a pattern.
+     * An empty pattern matches all enabled candidates with their bonus as score.
+     * Thread-safe for concurrent calls on a const matcher.
+     * @param pattern pattern to match, case-insensitive for ASCII
+     * @param maxResults maximal number of results
+     * @return best matches, ordered by descending score, ties by ascending id
+     */
+    QVector<Match> match(const QString &pattern, int maxResults) const;
+
+    /**
+     * Score one candidate, without bonus.
+     * @param id candidate id
+     * @param pattern pattern as returned by preparePattern()
+     * @return score, or -1 if the candidate does not match
+     */
+    int score(int id, const QByteArray &pattern) const;
+
+    /**
+     * Convert a pattern into the form used by score().
+     * @param pattern user input
+     * @return ASCII-lowercased UTF-8 pattern
+     */
+    static QByteArray preparePattern(const QString &pattern);
+
+private:
+    /**
+     * Score the candidates [begin, end), keep the best maxResults.
+     */
+    QVector<Match> matchRange(int begin, int end, const QByteArray &pattern, int maxResults) const;
+
+    bool isBoundary(int pos) const {
+        return m_boundaries.at(pos >> 3) & (1 << (pos & 7));
+    }
+
+private:
+    /**
+     * lowercased bytes of all candidates, concatenated
+     */
+    QByteArray m_text;
+
+    /**
+     * one bit per byte of m_text, set for word boundaries
+     */
+    QByteArray m_boundaries;
+
+    /**
+     * start of candidate i in m_text, one extra entry for the end
+     */
+    QVector<int> m_offsets;
+
+    /**
+     * start of the file name of candidate i in m_text
+     */
+    QVector<int> m_fileNameOffsets;
+
+    /**
+     * enabled state of candidate i
+     */
+    QBitArray m_enabled;
+
+    /**
+     * bonus of candidate i
+     */
+    QVector<int> m_bonus;
+};
+
+Q_DECLARE_TYPEINFO(KateQuickOpenMatcher::Match, Q_PRIMITIVE_TYPE);
+
+#endif
@@ -0,0 +1,160 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katequickopenmodel.h"
+
+#include <QBitArray>
+#include <QFont>
+
+namespace
+{
+/**
+ * only that many best matches are shown for a non-empty filter
+ */
+const int MaxMatches = 512;
+}
+
+KateQuickOpenModel::KateQuickOpenModel(KateQuickOpenIndex *index, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_index(index)
+    , m_active(false)
+    , m_stale(true)
+{
+    connect(m_index, &KateQuickOpenIndex::changed, this, &KateQuickOpenModel::invalidate);
+}
+
+void KateQuickOpenModel::setDocumentOrder(const QList<KTextEditor::Document *> &documents)
+{
+    m_documentOrder = documents;
+    if (m_filter.isEmpty()) {
+        invalidate();
+    }
+}
+
+void KateQuickOpenModel::setFilterString(const QString &filter)
+{
+    m_filter = filter;
+    invalidate();
+}
+
+void KateQuickOpenModel::setActive(bool active)
+{
+    m_active = active;
+    if (m_active && m_stale) {
+        refresh();
+    }
+}
+
+void KateQuickOpenModel::invalidate()
+{
+    if (m_active) {
+        refresh();
+        return;
+    }
+
+    /**
+     * not in use: rebuild later, but drop the rows now, their ids might
+     * not be valid any longer
+     */
+    m_stale = true;
+    if (!m_rows.isEmpty()) {
+        beginResetModel();
+        m_rows.clear();
+        endResetModel();
+    }
+}
+
+void KateQuickOpenModel::refresh()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_stale = false;
+
+    const KateQuickOpenMatcher &matcher = m_index->matcher();
+    if (m_filter.isEmpty()) {
+        /**
+         * no filter: given documents first, then the rest in index order,
+         * no scoring needed
+         */
+        QBitArray seen(matcher.size());
+        for (KTextEditor::Document *document : m_documentOrder) {
+            const int id = m_index->documentId(document);
+            if (id >= 0 && !seen.testBit(id)) {
+                seen.setBit(id);
+                m_rows.append(id);
+            }
+        }
+
+        m_rows.reserve(matcher.size());
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int id = 0; id < matcher.size(); ++id) {
+                const bool isDocument = m_index->entry(id).document;
+                if (matcher.isEnabled(id) && isDocument == (pass == 0) && !seen.testBit(id)) {
+                    m_rows.append(id);
+                }
+            }
+        }
+    } else {
+        const QVector<KateQuickOpenMatcher::Match> matches = matcher.match(m_filter, MaxMatches);
+        m_rows.reserve(matches.size());
+        for (const KateQuickOpenMatcher::Match &match : matches) {
+            m_rows.append(match.id);
+        }
+    }
+
+    endResetModel();
+}
+
+int KateQuickOpenModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int KateQuickOpenModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant KateQuickOpenModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const KateQuickOpenEntry &entry = m_index->entry(m_rows.at(index.row()));
+    switch (role) {
+    case Qt::DisplayRole:
+        return index.column() == 0 ? entry.fileName : entry.filePath;
+
+    case Qt::FontRole:
+        if (index.column() == 0 && entry.document) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        break;
+
+    case DocumentRole:
+        return QVariant::fromValue(entry.document);
+
+    case UrlRole:
+        return entry.url;
+    }
+
+    return QVariant();
+}
@@ -0,0 +1,114 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_QUICK_OPEN_MODEL_H
+#define KATE_QUICK_OPEN_MODEL_H
+
+#include "katequickopenindex.h"
+
+#include <QAbstractTableModel>
+
+/**
+ * Model for the quick open of one main window.
+ * Shows the entries of the shared quick open index, filtering is done by the
+ * fuzzy matcher, the rows are the best matching entries, ordered by score.
+ */
+class KateQuickOpenModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Role {
+        DocumentRole = Qt::UserRole + 1,
+        UrlRole
+    };
+
+    /**
+     * Construct model.
+     * @param index shared index to show
+     * @param parent parent object
+     */
+    KateQuickOpenModel(KateQuickOpenIndex *index, QObject *parent = nullptr);
+
+    /**
+     * Set the documents to show first while no filter is set,
+     * e.g. in least recently used order of the views.
+     * @param documents documents to show first
+     */
+    void setDocumentOrder(const QList<KTextEditor::Document *> &documents);
+
+    /**
+     * Filter and rank entries.
+     * @param filter fuzzy pattern, empty shows all entries
+     */
+    void setFilterString(const QString &filter);
+
+    /**
+     * Activate or deactivate the model, e.g. while the quick open is shown.
+     * While inactive, changes only mark the rows as outdated, they are
+     * rebuilt once the model is activated again.
+     * @param active is the model in use?
+     */
+    void setActive(bool active);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+private Q_SLOTS:
+    /**
+     * Index, filter or order changed, ids might be outdated.
+     * Filter again if active, else just mark the rows as outdated.
+     */
+    void invalidate();
+
+private:
+    /**
+     * Filter and rank again.
+     */
+    void refresh();
+
+private:
+    /**
+     * shared index
+     */
+    KateQuickOpenIndex *m_index;
+
+    /**
+     * documents to show first without filter
+     */
+    QList<KTextEditor::Document *> m_documentOrder;
+
+    /**
+     * current filter
+     */
+    QString m_filter;
+
+    /**
+     * visible rows, entry ids
+     */
+    QVector<int> m_rows;
+
+    /**
+     * in use? rows outdated?
+     */
+    bool m_active;
+    bool m_stale;
+};
+
+#endif
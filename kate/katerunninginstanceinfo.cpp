@@ -22,6 +22,9 @@
 #include <QStringList>
 #include <QCoreApplication>
 #include <QDBusConnectionInterface>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 int KateRunningInstanceInfo::dummy_session = 0;
 
@@ -71,3 +74,32 @@ void cleanupRunningKateAppInstanceMap(KateRunningInstanceMap *map)
     map->clear();
 }
 
+static QString cachedKateAppInstanceFile(int desktop)
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty()) {
+        return QString();
+    }
+    return dir + QStringLiteral("/kate-instance-%1").arg(desktop);
+}
+
+QString cachedKateAppInstance(int desktop)
+{
+    QFile file(cachedKateAppInstanceFile(desktop));
+    if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    const QString serviceName = QString::fromUtf8(file.readAll()).trimmed();
+    return serviceName.startsWith(QStringLiteral("org.kde.kate-")) ? serviceName : QString();
+}
+
+void setCachedKateAppInstance(int desktop, const QString &serviceName)
+{
+    QSaveFile file(cachedKateAppInstanceFile(desktop));
+    if (file.fileName().isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(serviceName.toUtf8());
+    file.commit();
+}
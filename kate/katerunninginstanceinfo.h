@@ -74,5 +74,12 @@ typedef QMap<QString, KateRunningInstanceInfo *> KateRunningInstanceMap;
 Q_DECL_EXPORT bool fillinRunningKateAppInstances(KateRunningInstanceMap *map);
 Q_DECL_EXPORT void cleanupRunningKateAppInstanceMap(KateRunningInstanceMap *map);
 
+/**
+ * service name of the instance last reused from the given desktop, empty if none known
+ * the caller has to check that it is still running
+ */
+Q_DECL_EXPORT QString cachedKateAppInstance(int desktop);
+Q_DECL_EXPORT void setCachedKateAppInstance(int desktop, const QString &serviceName);
+
 #endif
 
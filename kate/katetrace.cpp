@@ -0,0 +1,146 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "katetrace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+
+namespace
+{
+/**
+ * one recorded event, complete scope or counter
+ */
+struct Event {
+    QString name;
+    bool counter;
+    qint64 timestamp;
+    qint64 value;
+    quint64 thread;
+};
+
+struct TraceData {
+    QMutex mutex;
+    QString fileName;
+    QElapsedTimer timer;
+    QVector<Event> events;
+};
+
+Q_GLOBAL_STATIC(TraceData, traceData)
+
+/**
+ * fast check for trace points
+ */
+QAtomicInt enabled;
+
+quint64 currentThread()
+{
+    return quint64(quintptr(QThread::currentThreadId()));
+}
+}
+
+void KateTrace::start(const QString &fileName)
+{
+    QMutexLocker locker(&traceData()->mutex);
+    traceData()->fileName = fileName;
+    traceData()->timer.start();
+    traceData()->events.clear();
+    enabled.store(1);
+}
+
+bool KateTrace::isEnabled()
+{
+    return enabled.load();
+}
+
+qint64 KateTrace::now()
+{
+    return traceData()->timer.nsecsElapsed() / 1000;
+}
+
+void KateTrace::counter(const QString &name, qint64 value)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    const Event event = { name, true, now(), value, currentThread() };
+    QMutexLocker locker(&traceData()->mutex);
+    traceData()->events.append(event);
+}
+
+void KateTrace::complete(const QString &name, qint64 begin, qint64 end)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    const Event event = { name, false, begin, end - begin, currentThread() };
+    QMutexLocker locker(&traceData()->mutex);
+    traceData()->events.append(event);
+}
+
+void KateTrace::write()
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QMutexLocker locker(&traceData()->mutex);
+
+    /**
+     * trace-event format: complete events (X) with duration, counters (C) with args
+     */
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    for (const Event &event : traceData()->events) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), event.name);
+        object.insert(QStringLiteral("pid"), pid);
+        object.insert(QStringLiteral("tid"), qint64(event.thread));
+        object.insert(QStringLiteral("ts"), event.timestamp);
+        if (event.counter) {
+            QJsonObject args;
+            args.insert(QStringLiteral("value"), event.value);
+            object.insert(QStringLiteral("ph"), QStringLiteral("C"));
+            object.insert(QStringLiteral("args"), args);
+        } else {
+            object.insert(QStringLiteral("ph"), QStringLiteral("X"));
+            object.insert(QStringLiteral("dur"), event.value);
+        }
+        events.append(object);
+    }
+
+    QJsonObject trace;
+    trace.insert(QStringLiteral("traceEvents"), events);
+    trace.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+
+    QSaveFile file(traceData()->fileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
@@ -0,0 +1,111 @@
+/* This file is part of the KDE project
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_TRACE_H
+#define KATE_TRACE_H
+
+#include <QString>
+
+#include "kateprivate_export.h"
+
+/**
+ * Built-in performance tracing, e.g. for startup.
+ *
+ * Once started, scopes and counters are recorded in memory and written
+ * as Chrome trace-event JSON, loadable in chrome://tracing or Perfetto.
+ * Enabled via the --trace-file option or the KATE_TRACE_FILE environment
+ * variable. While disabled, trace points cost one atomic load.
+ */
+class KATE_TESTS_EXPORT KateTrace
+{
+public:
+    /**
+     * Start tracing, the timeline starts now.
+     * @param fileName file to write the trace to
+     */
+    static void start(const QString &fileName);
+
+    /**
+     * Is tracing enabled?
+     * @return true if started
+     */
+    static bool isEnabled();
+
+    /**
+     * Record a counter value, e.g. the number of loaded plugins.
+     * @param name counter name
+     * @param value current value
+     */
+    static void counter(const QString &name, qint64 value);
+
+    /**
+     * Record a completed scope, used by KateTraceScope.
+     * @param name scope name
+     * @param begin begin in microseconds since start
+     * @param end end in microseconds since start
+     */
+    static void complete(const QString &name, qint64 begin, qint64 end);
+
+    /**
+     * Microseconds since start.
+     * @return timestamp
+     */
+    static qint64 now();
+
+    /**
+     * Write all events recorded so far to the trace file, replaces it.
+     */
+    static void write();
+};
+
+/**
+ * Traces the lifetime of the object as one scope:
+ * KateTraceScope trace("KateApp::init");
+ */
+class KATE_TESTS_EXPORT KateTraceScope
+{
+public:
+    explicit KateTraceScope(const char *name)
+        : m_begin(KateTrace::isEnabled() ? KateTrace::now() : -1)
+        , m_latin1Name(name)
+    {
+    }
+
+    explicit KateTraceScope(const QString &name)
+        : m_begin(KateTrace::isEnabled() ? KateTrace::now() : -1)
+        , m_latin1Name(nullptr)
+        , m_name(name)
+    {
+    }
+
+    ~KateTraceScope()
+    {
+        if (m_begin >= 0) {
+            KateTrace::complete(m_latin1Name ? QString::fromLatin1(m_latin1Name) : m_name, m_begin, KateTrace::now());
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(KateTraceScope)
+
+    const qint64 m_begin;
+    const char *const m_latin1Name;
+    const QString m_name;
+};
+
+#endif
@@ -446,6 +446,9 @@ KTextEditor::View *KateViewManager::createView(KTextEditor::Document *doc, KateV
         doc = KateApp::self()->documentManager()->createDoc();
     }
 
+    // placeholder of a lazy session restore? load it now
+    KateApp::self()->documentManager()->loadPlaceholder(doc);
+
     /**
      * create view, registers its XML gui itself
      * pass the view the correct main window
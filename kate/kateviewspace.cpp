@@ -352,8 +352,10 @@ void KateViewSpace::insertTab(int index, KTextEditor::Document * doc)
     // doc should not have a id
     Q_ASSERT(! m_docToTabId.contains(doc));
 
-    const int id = m_tabBar->insertTab(index, doc->documentName());
-    m_tabBar->setTabToolTip(id, doc->url().toDisplayString());
+    // placeholders of a lazy session restore have no name yet, ask the document manager
+    KateDocManager *docManager = KateApp::self()->documentManager();
+    const int id = m_tabBar->insertTab(index, docManager->documentName(doc));
+    m_tabBar->setTabToolTip(id, docManager->documentUrl(doc).toDisplayString());
     m_docToTabId[doc] = id;
 
     connect(doc, SIGNAL(documentNameChanged(KTextEditor::Document*)),
@@ -562,7 +564,7 @@ void KateViewSpace::focusNextTab()
 
 int KateViewSpace::hiddenDocuments() const
 {
-    const int hiddenDocs = KateApp::self()->documents().count() - m_tabBar->count();
+    const int hiddenDocs = KateApp::self()->documentManager()->documentList().count() - m_tabBar->count();
     Q_ASSERT(hiddenDocs >= 0);
     return hiddenDocs;
 }
@@ -618,7 +620,7 @@ void KateViewSpace::saveConfig(KConfigBase *config, int myIndex , const QString
     QVector<KTextEditor::View*> views;
     QStringList lruList;
     Q_FOREACH(KTextEditor::Document* doc, m_lruDocList) {
-        lruList << doc->url().toString();
+        lruList << KateApp::self()->documentManager()->documentUrl(doc).toString();
         if (m_docToView.contains(doc)) {
             views.append(m_docToView[doc]);
         }
@@ -21,6 +21,7 @@
 
 #include "kateapp.h"
 #include "katerunninginstanceinfo.h"
+#include "katetrace.h"
 #include "katewaiter.h"
 
 #include <KAboutData>
@@ -44,6 +45,7 @@
 #include <QDBusReply>
 #include <QApplication>
 #include <QDir>
+#include <QTimer>
 
 #include "../urlinfo.h"
 
@@ -59,6 +61,14 @@ int main(int argc, char **argv)
      */
     Q_INIT_RESOURCE(kate);
 
+    /**
+     * tracing requested via environment? start as early as possible
+     */
+    const QString traceFile = QString::fromLocal8Bit(qgetenv("KATE_TRACE_FILE"));
+    if (!traceFile.isEmpty()) {
+        KateTrace::start(traceFile);
+    }
+
     /**
      * Create application first
      */
@@ -218,6 +228,10 @@ int main(int argc, char **argv)
     const QCommandLineOption tempfileOption(QStringList() << QStringLiteral("tempfile"), i18n("The files/URLs opened by the application will be deleted after use"));
     parser.addOption(tempfileOption);
 
+    // --trace-file option
+    const QCommandLineOption traceFileOption(QStringList() << QStringLiteral("trace-file"), i18n("Write a performance trace of this kate instance to the given file."), i18n("file"));
+    parser.addOption(traceFileOption);
+
     // urls to open
     parser.addPositionalArgument(QStringLiteral("urls"), i18n("Documents to open."), i18n("[urls...]"));
 
@@ -231,6 +245,13 @@ int main(int argc, char **argv)
      */
     aboutData.processCommandLine(&parser);
 
+    /**
+     * tracing requested via command line?
+     */
+    if (parser.isSet(traceFileOption) && !KateTrace::isEnabled()) {
+        KateTrace::start(parser.value(traceFileOption));
+    }
+
     /**
      * remember the urls we shall open
      */
@@ -269,90 +290,103 @@ int main(int argc, char **argv)
 #ifndef USE_QT_SINGLE_APP
     if (QDBusConnectionInterface * const sessionBusInterface = QDBusConnection::sessionBus().interface()) {
         /**
-         * try to get the current running kate instances
+         * desktop a running instance is on, -1 if it is gone or does not answer
          */
-        KateRunningInstanceMap mapSessionRii;
-        if (!fillinRunningKateAppInstances(&mapSessionRii)) {
-            return 1;
-        }
+        auto instanceDesktopNumber = [sessionBusInterface](const QString & serviceName) {
+            QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
+            if (!there.isValid() || !there.value()) {
+                return -1;
+            }
 
-        QStringList kateServices;
-        for (KateRunningInstanceMap::const_iterator it = mapSessionRii.constBegin(); it != mapSessionRii.constEnd(); ++it) {
-            kateServices << (*it)->serviceName;
-        }
-        QString serviceName;
+            // query instance current desktop
+            QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
+                             QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("desktopNumber"));
+
+            QDBusMessage res = QDBusConnection::sessionBus().call(m);
+            QList<QVariant> answer = res.arguments();
+            return (answer.size() == 1) ? answer.at(0).toInt() : -1;
+        };
 
+        QString serviceName;
         QString start_session;
         bool session_already_opened = false;
 
-        //check if we try to start an already opened session
-        if (parser.isSet(startAnonymousSessionOption)) {
-            force_new = true;
-        } else if (parser.isSet(startSessionOption)) {
-            start_session = parser.value(startSessionOption);
-            if (mapSessionRii.contains(start_session)) {
-                serviceName = mapSessionRii[start_session]->serviceName;
-                force_new = false;
-                session_already_opened = true;
+        /**
+         * without session or pid wishes, first try the instance we used last time from this desktop,
+         * that avoids asking all running instances for their session
+         */
+        const int desktopnumber = KWindowSystem::currentDesktop();
+        const bool plainReuse = !force_new && !parser.isSet(startAnonymousSessionOption) && !parser.isSet(startSessionOption)
+                                && !parser.isSet(usePidOption) && qgetenv("KATE_PID").isEmpty();
+        if (plainReuse) {
+            serviceName = cachedKateAppInstance(desktopnumber);
+            if (!serviceName.isEmpty() && instanceDesktopNumber(serviceName) != desktopnumber) {
+                serviceName.clear();
             }
         }
 
-        //cleanup map
-        cleanupRunningKateAppInstanceMap(&mapSessionRii);
-
-        //if no new instance is forced and no already opened session is requested,
-        //check if a pid is given, which should be reused.
-        // two possibilities: pid given or not...
-        if ((!force_new) && serviceName.isEmpty()) {
-            if ((parser.isSet(usePidOption)) || (!qgetenv("KATE_PID").isEmpty())) {
-                QString usePid = (parser.isSet(usePidOption)) ?
-                                parser.value(usePidOption) :
-                                QString::fromLocal8Bit(qgetenv("KATE_PID"));
-
-                serviceName = QStringLiteral("org.kde.kate-") + usePid;
-                if (!kateServices.contains(serviceName)) {
-                    serviceName.clear();
-                }
+        if (serviceName.isEmpty()) {
+            /**
+             * try to get the current running kate instances
+             */
+            KateRunningInstanceMap mapSessionRii;
+            if (!fillinRunningKateAppInstances(&mapSessionRii)) {
+                return 1;
             }
-        }
-
-        // prefer the Kate instance running on the current virtual desktop
-        bool foundRunningService = false;
-        if ((!force_new) && (serviceName.isEmpty())) {
-            const int desktopnumber = KWindowSystem::currentDesktop();
-            int sessionDesktopNumber;
-            for (int s = 0; s < kateServices.count(); s++) {
-
-                serviceName = kateServices[s];
 
-                if (!serviceName.isEmpty()) {
-                    QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
+            QStringList kateServices;
+            for (KateRunningInstanceMap::const_iterator it = mapSessionRii.constBegin(); it != mapSessionRii.constEnd(); ++it) {
+                kateServices << (*it)->serviceName;
+            }
 
-                    if (there.isValid() && there.value()) {
-                        sessionDesktopNumber = -1;
+            //check if we try to start an already opened session
+            if (parser.isSet(startAnonymousSessionOption)) {
+                force_new = true;
+            } else if (parser.isSet(startSessionOption)) {
+                start_session = parser.value(startSessionOption);
+                if (mapSessionRii.contains(start_session)) {
+                    serviceName = mapSessionRii[start_session]->serviceName;
+                    force_new = false;
+                    session_already_opened = true;
+                }
+            }
 
-                        // query instance current desktop
-                        QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
-                                         QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("desktopNumber"));
+            //cleanup map
+            cleanupRunningKateAppInstanceMap(&mapSessionRii);
+
+            //if no new instance is forced and no already opened session is requested,
+            //check if a pid is given, which should be reused.
+            // two possibilities: pid given or not...
+            if ((!force_new) && serviceName.isEmpty()) {
+                if ((parser.isSet(usePidOption)) || (!qgetenv("KATE_PID").isEmpty())) {
+                    QString usePid = (parser.isSet(usePidOption)) ?
+                                    parser.value(usePidOption) :
+                                    QString::fromLocal8Bit(qgetenv("KATE_PID"));
+
+                    serviceName = QStringLiteral("org.kde.kate-") + usePid;
+                    if (!kateServices.contains(serviceName)) {
+                        serviceName.clear();
+                    }
+                }
+            }
 
-                        QDBusMessage res = QDBusConnection::sessionBus().call(m);
-                        QList<QVariant> answer = res.arguments();
-                        if (answer.size() == 1) {
-                            sessionDesktopNumber = answer.at(0).toInt();
-                            if (sessionDesktopNumber ==  desktopnumber) {
-                                // stop searching. a candidate instance in the current desktop has been found
-                                foundRunningService = true;
-                                break;
-                            }
+            // prefer the Kate instance running on the current virtual desktop
+            if ((!force_new) && (serviceName.isEmpty())) {
+                for (int s = 0; s < kateServices.count(); s++) {
+                    if (instanceDesktopNumber(kateServices[s]) == desktopnumber) {
+                        // stop searching. a candidate instance in the current desktop has been found
+                        serviceName = kateServices[s];
+                        if (plainReuse) {
+                            setCachedKateAppInstance(desktopnumber, serviceName);
                         }
+                        break;
                     }
                 }
-                serviceName.clear();
             }
         }
 
         //check again if service is still running
-        foundRunningService = false;
+        bool foundRunningService = false;
         if (!serviceName.isEmpty()) {
             QDBusReply<bool> there = sessionBusInterface->isServiceRegistered(serviceName);
             foundRunningService = there.isValid() && there.value();
@@ -377,33 +411,76 @@ int main(int argc, char **argv)
 
             QStringList tokens;
 
-            // open given files...
+            /**
+             * activate the used instance with the same call if nothing else follows
+             */
+            const bool nav = parser.isSet(gotoLineOption) || parser.isSet(gotoColumnOption);
+            const bool activateWithOpen = !nav && !parser.isSet(readStdInOption);
+
+            // open given files, all in one call
+            QStringList fileUrls;
+            QList<int> fileLines;
+            QList<int> fileColumns;
             foreach(const QString & url, urls) {
+                UrlInfo info(url);
+                fileUrls << info.url.toString();
+                fileLines << info.cursor.line();
+                fileColumns << info.cursor.column();
+            }
+
+            bool activated = false;
+            if (!fileUrls.isEmpty()) {
                 QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
-                                QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlAt"));
+                                QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlsAt"));
 
-                UrlInfo info(url);
                 QList<QVariant> dbusargs;
-
-                // convert to an url
-                dbusargs.append(info.url.toString());
-                dbusargs.append(info.cursor.line());
-                dbusargs.append(info.cursor.column());
+                dbusargs.append(fileUrls);
+                dbusargs.append(QVariant::fromValue(fileLines));
+                dbusargs.append(QVariant::fromValue(fileColumns));
                 dbusargs.append(enc);
                 dbusargs.append(tempfileSet);
+                dbusargs.append(activateWithOpen);
                 m.setArguments(dbusargs);
 
-                QDBusMessage res = QDBusConnection::sessionBus().call(m);
+                // loading many files can take longer than the default 25 seconds
+                const int batchTimeout = 5 * 60 * 1000;
+                QDBusMessage res = QDBusConnection::sessionBus().call(m, QDBus::Block, batchTimeout);
                 if (res.type() == QDBusMessage::ReplyMessage) {
                     if (res.arguments().count() == 1) {
-                        QVariant v = res.arguments()[0];
-                        if (v.isValid()) {
-                            QString s = v.toString();
+                        foreach(const QString & s, res.arguments()[0].toStringList()) {
                             if ((!s.isEmpty()) && (s != QStringLiteral("ERROR"))) {
                                 tokens << s;
                             }
                         }
                     }
+                    activated = activateWithOpen;
+                } else if (res.errorName() == QStringLiteral("org.freedesktop.DBus.Error.UnknownMethod")) {
+                    // older instance without the batch call, open one by one
+                    for (int i = 0; i < fileUrls.size(); ++i) {
+                        QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
+                                        QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlAt"));
+
+                        QList<QVariant> dbusargs;
+                        dbusargs.append(fileUrls.at(i));
+                        dbusargs.append(fileLines.at(i));
+                        dbusargs.append(fileColumns.at(i));
+                        dbusargs.append(enc);
+                        dbusargs.append(tempfileSet);
+                        m.setArguments(dbusargs);
+
+                        QDBusMessage res = QDBusConnection::sessionBus().call(m);
+                        if (res.type() == QDBusMessage::ReplyMessage) {
+                            if (res.arguments().count() == 1) {
+                                QVariant v = res.arguments()[0];
+                                if (v.isValid()) {
+                                    QString s = v.toString();
+                                    if ((!s.isEmpty()) && (s != QStringLiteral("ERROR"))) {
+                                        tokens << s;
+                                    }
+                                }
+                            }
+                        }
+                    }
                 }
             }
 
@@ -439,16 +516,13 @@ int main(int argc, char **argv)
 
             int line = 0;
             int column = 0;
-            bool nav = false;
 
             if (parser.isSet(gotoLineOption)) {
                 line = parser.value(gotoLineOption).toInt() - 1;
-                nav = true;
             }
 
             if (parser.isSet(gotoColumnOption)) {
                 column = parser.value(gotoColumnOption).toInt() - 1;
-                nav = true;
             }
 
             if (nav) {
@@ -464,9 +538,11 @@ int main(int argc, char **argv)
             }
 
             // activate the used instance
-            QDBusMessage activateMsg = QDBusMessage::createMethodCall(serviceName,
-                                    QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("activate"));
-            QDBusConnection::sessionBus().call(activateMsg);
+            if (!activated) {
+                QDBusMessage activateMsg = QDBusMessage::createMethodCall(serviceName,
+                                        QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("activate"));
+                QDBusConnection::sessionBus().call(activateMsg);
+            }
 
             // connect dbus signal
             if (needToBlock) {
@@ -553,8 +629,11 @@ int main(int argc, char **argv)
      * if this returns false, we shall exit
      * else we may enter the main event loop
      */
-    if (!kateApp.init()) {
-        return 0;
+    {
+        KateTraceScope trace("KateApp::init");
+        if (!kateApp.init()) {
+            return 0;
+        }
     }
 
 #ifndef USE_QT_SINGLE_APP
@@ -571,8 +650,20 @@ int main(int argc, char **argv)
 #endif
 
 
+    /**
+     * startup is done once the event loop processed the first events, write the trace then
+     * write it once more on exit, with everything that happened later
+     */
+    if (KateTrace::isEnabled()) {
+        QTimer::singleShot(0, [] () {
+            KateTrace::write();
+        });
+    }
+
     /**
      * start main event loop for our application
      */
-    return app.exec();
+    const int result = app.exec();
+    KateTrace::write();
+    return result;
 }
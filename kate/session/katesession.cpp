@@ -56,6 +56,17 @@ KateSession::KateSession(const QString &file, const QString &name, const bool an
     m_documents = config()->group(opGroupName).readEntry(keyCount, 0);
 }
 
+KateSession::KateSession(const QString &file, const QString &name, const unsigned int documents, const QDateTime &timestamp)
+    : m_name(name)
+    , m_file(file)
+    , m_anonymous(false)
+    , m_documents(documents)
+    , m_config(0)
+    , m_timestamp(timestamp)
+{
+    Q_ASSERT(!m_file.isEmpty());
+}
+
 KateSession::~KateSession()
 {
     delete m_config;
@@ -72,6 +83,18 @@ void KateSession::setDocuments(const unsigned int number)
     m_documents = number;
 }
 
+void KateSession::setInfo(const unsigned int documents, const QDateTime &timestamp)
+{
+    m_documents = documents;
+    m_timestamp = timestamp;
+}
+
+unsigned int KateSession::readDocuments(const QString &file)
+{
+    KConfig config(file, KConfig::SimpleConfig);
+    return config.group(opGroupName).readEntry(keyCount, 0);
+}
+
 void KateSession::setFile(const QString &filename)
 {
     if (m_config) {
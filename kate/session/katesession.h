@@ -123,6 +123,21 @@ private:
      */
     KateSession(const QString &file, const QString &name, const bool anonymous, const KConfig *config = 0);
 
+    /**
+     * named session with infos known from the session index, does not read the file
+     */
+    KateSession(const QString &file, const QString &name, const unsigned int documents, const QDateTime &timestamp);
+
+    /**
+     * update infos read from the session file in the background
+     */
+    void setInfo(const unsigned int documents, const QDateTime &timestamp);
+
+    /**
+     * read the document count of a session file, usable from any thread
+     */
+    static unsigned int readDocuments(const QString &file);
+
 private:
     QString m_name;
     QString m_file;
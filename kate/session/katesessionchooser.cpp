@@ -87,6 +87,7 @@ KateSessionChooser::KateSessionChooser(QWidget *parent, const QString &lastSessi
 
     connect(m_sessions, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)), this, SLOT(selectionChanged(QTreeWidgetItem*,QTreeWidgetItem*)));
     connect(m_sessions, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(slotOpen()));
+    connect(KateApp::self()->sessionManager(), SIGNAL(sessionListChanged()), this, SLOT(updateDocuments()));
 
     // bottom box
     QHBoxLayout *hb = new QHBoxLayout();
@@ -185,3 +186,9 @@ void KateSessionChooser::selectionChanged(QTreeWidgetItem *current, QTreeWidgetI
 
 //END CHOOSER DIALOG
 
+void KateSessionChooser::updateDocuments()
+{
+    for (int i = 0; i < m_sessions->topLevelItemCount(); ++i) {
+        static_cast<KateSessionChooserItem *>(m_sessions->topLevelItem(i))->updateDocuments();
+    }
+}
@@ -61,6 +61,11 @@ protected Q_SLOTS:
      */
     void selectionChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
 
+    /**
+     * document counts might have been read in the background
+     */
+    void updateDocuments();
+
 private:
     QTreeWidget *m_sessions;
     QCheckBox *m_useLast;
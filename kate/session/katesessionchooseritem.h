@@ -31,8 +31,15 @@ public:
     KateSessionChooserItem(QTreeWidget *tw, KateSession::Ptr s)
         : QTreeWidgetItem(tw, QStringList(s->name()))
         , session(s) {
+        updateDocuments();
+    }
+
+    /**
+     * show the current document count of the session
+     */
+    void updateDocuments() {
         QString docs;
-        docs.setNum(s->documents());
+        docs.setNum(session->documents());
         setText(1, docs);
     }
 
@@ -29,6 +29,7 @@
 #include "kateapp.h"
 #include "katepluginmanager.h"
 #include "katerunninginstanceinfo.h"
+#include "katetrace.h"
 
 #include <KConfigGroup>
 #include <KSharedConfig>
@@ -38,18 +39,91 @@
 #include <KDirWatch>
 
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QInputDialog>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QUrl>
 
+#include <functional>
+
 #ifndef Q_OS_WIN
 #include <unistd.h>
 #endif
 
+namespace
+{
+/**
+ * session index file format
+ */
+const quint32 SessionIndexMagic = 0x4b534958;
+const quint32 SessionIndexVersion = 1;
+
+/**
+ * dir modification times younger than that are not trusted,
+ * coarse file system timestamps might hide later changes
+ */
+const qint64 SessionIndexDirTimeSlack = 2000;
+
+/**
+ * runs a function on the thread pool
+ */
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(const std::function<void()> &function)
+        : m_function(function)
+    {
+    }
+
+    void run()
+    {
+        m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+};
+
+/**
+ * try to get a written file to disk
+ */
+void syncFileToDisk(const QString &fileName)
+{
+    QFile fileToSync(fileName);
+    if (fileToSync.open(QIODevice::ReadOnly)) {
+#ifndef Q_OS_WIN
+        // ensure that the file is written to disk
+#ifdef HAVE_FDATASYNC
+        fdatasync(fileToSync.handle());
+#else
+        fsync(fileToSync.handle());
+#endif
+#endif
+    }
+}
+
+QString sessionNameForFile(const QString &fileName)
+{
+    QString name = fileName;
+    name.chop(12); // .katesession
+    return QUrl::fromPercentEncoding(name.toLatin1());
+}
+}
+
 //BEGIN KateSessionManager
 
 KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsDir)
     : QObject(parent)
+    , m_sessionIndexDirTime(-1)
+    , m_activatingSession(false)
 {
     if (sessionsDir.isEmpty()) {
         m_sessionsDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kate/sessions");
@@ -64,27 +138,63 @@ KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsD
     m_dirWatch->addDir(m_sessionsDir);
     connect(m_dirWatch, SIGNAL(dirty(QString)), this, SLOT(updateSessionList()));
 
-    updateSessionList();
+    // without index, read all session files now, the chooser needs them at once
+    m_sessionScanner.setMaxThreadCount(1);
+    m_sessionIndexFile = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/sessionindex-")
+                         + QString::fromLatin1(QCryptographicHash::hash(m_sessionsDir.toUtf8(), QCryptographicHash::Md5).toHex());
+    updateSessionList(!loadSessionIndex());
+
+    // save the active session from time to time, a crash should not lose it
+    m_sessionWriter.setMaxThreadCount(1);
+    m_autoSaveTimer = new QTimer(this);
+    connect(m_autoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSaveActiveSession()));
+    const int autoSaveMinutes = KConfigGroup(KSharedConfig::openConfig(), "General").readEntry("Session Autosave Interval", 5);
+    if (autoSaveMinutes > 0) {
+        m_autoSaveTimer->start(autoSaveMinutes * 60 * 1000);
+    }
 
     m_activeSession = KateSession::createAnonymous(anonymousSessionFile());
 }
 
 KateSessionManager::~KateSessionManager()
 {
+    m_sessionWriter.waitForDone();
+    m_sessionScanner.waitForDone();
     delete m_dirWatch;
 }
 
-void KateSessionManager::updateSessionList()
+void KateSessionManager::updateSessionList(bool synchronous)
 {
-    QStringList list;
-
-    // Let's get a list of all session we have atm
-    QDir dir(m_sessionsDir, QStringLiteral("*.katesession"));
+    /**
+     * the index stays valid as long as the dir is unchanged, else list the dir
+     * and read the new or changed session files, in the background if possible
+     */
+    const qint64 dirTime = QFileInfo(m_sessionsDir).lastModified().toMSecsSinceEpoch();
+    const bool indexChanged = (dirTime != m_sessionIndexDirTime);
+    QStringList changed;
+    if (indexChanged) {
+        QHash<QString, SessionFileInfo> index;
+        const QFileInfoList files = QDir(m_sessionsDir, QStringLiteral("*.katesession")).entryInfoList(QDir::Files);
+        foreach(const QFileInfo & fi, files) {
+            const SessionFileInfo unknown = { -1, -1, 0 };
+            SessionFileInfo info = m_sessionIndex.value(fi.fileName(), unknown);
+            if (info.mtime != fi.lastModified().toMSecsSinceEpoch() || info.size != fi.size()) {
+                if (synchronous) {
+                    info = readSessionFileInfo(fi.absoluteFilePath());
+                } else {
+                    info.mtime = -1; // unknown until read
+                    changed << fi.fileName();
+                }
+            }
+            index[fi.fileName()] = info;
+        }
+        m_sessionIndex = index;
+        m_sessionIndexDirTime = (QDateTime::currentMSecsSinceEpoch() - dirTime > SessionIndexDirTimeSlack) ? dirTime : -1;
+    }
 
-    for (unsigned int i = 0; i < dir.count(); ++i) {
-        QString name = dir[i];
-        name.chop(12); // .katesession
-        list << QUrl::fromPercentEncoding(name.toLatin1());
+    QHash<QString, QString> list;
+    for (QHash<QString, SessionFileInfo>::const_iterator it = m_sessionIndex.constBegin(); it != m_sessionIndex.constEnd(); ++it) {
+        list[sessionNameForFile(it.key())] = it.key();
     }
 
     // delete old items;
@@ -92,21 +202,150 @@ void KateSessionManager::updateSessionList()
 
     while (i.hasNext()) {
         i.next();
-        const int idx = list.indexOf(i.key());
-        if (idx == -1) { // the key is invalid, remove it from m_session
+        if (!list.contains(i.key())) { // the key is invalid, remove it from m_session
             if (i.value() != m_activeSession) { // if active, ignore missing config
                 i.remove();
             }
         } else { // remove it from scan list
-            list.removeAt(idx);
+            list.remove(i.key());
+        }
+    }
+
+    // add the new ones, with the infos we have
+    for (QHash<QString, QString>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) {
+        const SessionFileInfo &info = m_sessionIndex[it.value()];
+        const QDateTime timestamp = (info.mtime >= 0) ? QDateTime::fromMSecsSinceEpoch(info.mtime) : QDateTime();
+        m_sessions[it.key()] = KateSession::Ptr(new KateSession(sessionFileForName(it.key()), it.key(), info.documents, timestamp));
+    }
+
+    if (!indexChanged) {
+        return;
+    }
+
+    if (changed.isEmpty()) {
+        saveSessionIndex();
+    } else {
+        const QString dir = m_sessionsDir;
+        m_sessionScanner.start(new FunctionRunnable([this, dir, changed]() {
+            QHash<QString, SessionFileInfo> results;
+            foreach(const QString & fileName, changed) {
+                results[fileName] = readSessionFileInfo(dir + QStringLiteral("/") + fileName);
+            }
+
+            QMutexLocker locker(&m_sessionScanMutex);
+            for (QHash<QString, SessionFileInfo>::const_iterator it = results.constBegin(); it != results.constEnd(); ++it) {
+                m_sessionScanResults[it.key()] = it.value();
+            }
+            QMetaObject::invokeMethod(this, "applySessionScan", Qt::QueuedConnection);
+        }));
+    }
+
+    emit sessionListChanged();
+}
+
+void KateSessionManager::applySessionScan()
+{
+    QHash<QString, SessionFileInfo> results;
+    {
+        QMutexLocker locker(&m_sessionScanMutex);
+        results.swap(m_sessionScanResults);
+    }
+
+    if (results.isEmpty()) {
+        return;
+    }
+
+    for (QHash<QString, SessionFileInfo>::const_iterator it = results.constBegin(); it != results.constEnd(); ++it) {
+        // file vanished in between?
+        if (it.value().mtime < 0 || !m_sessionIndex.contains(it.key())) {
+            continue;
+        }
+
+        m_sessionIndex[it.key()] = it.value();
+        if (KateSession::Ptr session = m_sessions.value(sessionNameForFile(it.key()))) {
+            session->setInfo(it.value().documents, QDateTime::fromMSecsSinceEpoch(it.value().mtime));
+        }
+    }
+
+    saveSessionIndex();
+    emit sessionListChanged();
+}
+
+KateSessionManager::SessionFileInfo KateSessionManager::readSessionFileInfo(const QString &file)
+{
+    const QFileInfo fi(file);
+    SessionFileInfo info = { -1, -1, 0 };
+    if (fi.exists()) {
+        info.mtime = fi.lastModified().toMSecsSinceEpoch();
+        info.size = fi.size();
+        info.documents = KateSession::readDocuments(file);
+    }
+    return info;
+}
+
+bool KateSessionManager::loadSessionIndex()
+{
+    QFile file(m_sessionIndexFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString dir;
+    qint64 dirTime = -1;
+    quint32 count = 0;
+    stream >> magic >> version >> dir >> dirTime >> count;
+    if (magic != SessionIndexMagic || version != SessionIndexVersion || dir != m_sessionsDir || stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    QHash<QString, SessionFileInfo> index;
+    for (quint32 i = 0; i < count; ++i) {
+        QString fileName;
+        SessionFileInfo info;
+        quint32 documents = 0;
+        stream >> fileName >> info.mtime >> info.size >> documents;
+        info.documents = documents;
+        index[fileName] = info;
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    m_sessionIndex = index;
+    m_sessionIndexDirTime = dirTime;
+    return true;
+}
+
+void KateSessionManager::saveSessionIndex() const
+{
+    QDir().mkpath(QFileInfo(m_sessionIndexFile).absolutePath());
+    QSaveFile file(m_sessionIndexFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    // files not read yet force a listing of the dir on next load
+    qint64 dirTime = m_sessionIndexDirTime;
+    foreach(const SessionFileInfo & info, m_sessionIndex) {
+        if (info.mtime < 0) {
+            dirTime = -1;
         }
     }
 
-    // load the new ones
-    foreach(const QString & newName, list) {
-        const QString file = sessionFileForName(newName);
-        m_sessions[newName] = KateSession::create(file, newName);
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << SessionIndexMagic << SessionIndexVersion << m_sessionsDir << dirTime << quint32(m_sessionIndex.size());
+    for (QHash<QString, SessionFileInfo>::const_iterator it = m_sessionIndex.constBegin(); it != m_sessionIndex.constEnd(); ++it) {
+        stream << it.key() << it.value().mtime << it.value().size << quint32(it.value().documents);
     }
+
+    file.commit();
 }
 
 bool KateSessionManager::activateSession(KateSession::Ptr session,
@@ -136,10 +375,14 @@ bool KateSessionManager::activateSession(KateSession::Ptr session,
 
         cleanupRunningKateAppInstanceMap(&instances);
     }
+    // no autosave of half closed or half loaded sessions
+    m_activatingSession = true;
+
     // try to close and save last session
     if (closeAndSaveLast) {
         if (KateApp::self()->activeKateMainWindow()) {
             if (!KateApp::self()->activeKateMainWindow()->queryClose_internal()) {
+                m_activatingSession = false;
                 return true;
             }
         }
@@ -161,12 +404,15 @@ bool KateSessionManager::activateSession(KateSession::Ptr session,
         loadSession(session);
     }
 
+    m_activatingSession = false;
     emit sessionChanged();
     return true;
 }
 
 void KateSessionManager::loadSession(const KateSession::Ptr &session) const
 {
+    KateTraceScope trace("KateSessionManager::loadSession");
+
     // open the new session
     KSharedConfigPtr sharedConfig = KSharedConfig::openConfig();
     KConfig *sc = session->config();
@@ -246,6 +492,7 @@ KateSession::Ptr KateSessionManager::giveSession(const QString &name)
 
 void KateSessionManager::deleteSession(KateSession::Ptr session)
 {
+    m_sessionWriter.waitForDone();
     QFile::remove(session->file());
     if (session != activeSession()) {
         m_sessions.remove(session->name());
@@ -269,6 +516,7 @@ bool KateSessionManager::renameSession(KateSession::Ptr session, const QString &
         return false;
     }
 
+    m_sessionWriter.waitForDone();
     session->config()->sync();
 
     const QUrl srcUrl = QUrl::fromLocalFile(session->file());
@@ -293,7 +541,7 @@ bool KateSessionManager::renameSession(KateSession::Ptr session, const QString &
     return true;
 }
 
-void KateSessionManager::saveSessionTo(KConfig *sc) const
+void KateSessionManager::saveSessionTo(KConfig *sc, bool async)
 {
     // save plugin configs and which plugins to load
     KateApp::self()->pluginManager()->writeConfig(sc);
@@ -313,29 +561,31 @@ void KateSessionManager::saveSessionTo(KConfig *sc) const
         }
     }
 
-    sc->sync();
+    if (!async) {
+        // keep the order of writes
+        m_sessionWriter.waitForDone();
+        sc->sync();
+        syncFileToDisk(sc->name());
+        return;
+    }
 
     /**
-     * try to sync file to disk
+     * write a snapshot in the background, the config itself counts as written
      */
-    QFile fileToSync(sc->name());
-    if (fileToSync.open(QIODevice::ReadOnly)) {
-#ifndef Q_OS_WIN
-        // ensure that the file is written to disk
-#ifdef HAVE_FDATASYNC
-        fdatasync(fileToSync.handle());
-#else
-        fsync(fileToSync.handle());
-#endif
-#endif
-    }
+    KConfig *snapshot = sc->copyTo(sc->name());
+    sc->markAsClean();
+    m_sessionWriter.start(new FunctionRunnable([snapshot]() {
+        snapshot->sync();
+        syncFileToDisk(snapshot->name());
+        delete snapshot;
+    }));
 }
 
 bool KateSessionManager::saveActiveSession(bool rememberAsLast)
 {
     KConfig *sc = activeSession()->config();
 
-    saveSessionTo(sc);
+    saveSessionTo(sc, true);
 
     if (rememberAsLast) {
         KSharedConfigPtr c = KSharedConfig::openConfig();
@@ -409,6 +659,20 @@ bool KateSessionManager::chooseSession()
     return success;
 }
 
+void KateSessionManager::waitForWrites()
+{
+    m_sessionWriter.waitForDone();
+}
+
+void KateSessionManager::autoSaveActiveSession()
+{
+    if (m_activatingSession || KateApp::self()->mainWindowsCount() == 0) {
+        return;
+    }
+
+    saveActiveSession();
+}
+
 void KateSessionManager::sessionNew()
 {
     activateSession(giveSession(QString()));
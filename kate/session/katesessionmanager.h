@@ -25,6 +25,8 @@
 
 #include <QObject>
 #include <QHash>
+#include <QMutex>
+#include <QThreadPool>
 
 typedef QList<KateSession::Ptr> KateSessionList;
 
@@ -38,7 +40,8 @@ public:
 
     /**
      * allow access to the session list
-     * kept up to date by watching the dir
+     * kept up to date by watching the dir, document counts of new or changed
+     * session files are read in the background, see sessionListChanged()
      */
     KateSessionList sessionList();
 
@@ -65,6 +68,11 @@ public:
      */
     bool saveActiveSession(bool rememberAsLast = false);
 
+    /**
+     * block until all session files queued for writing are on disk
+     */
+    void waitForWrites();
+
     /**
      * return the current active session
      * sessionFile == empty means we have no session around for this instance of kate
@@ -121,6 +129,11 @@ Q_SIGNALS:
      */
     void sessionChanged();
 
+    /**
+     * Emitted, whenever sessions got added or removed or their document counts got updated.
+     */
+    void sessionListChanged();
+
     /**
      * module internal APIs
      */
@@ -157,8 +170,19 @@ public:
 private Q_SLOTS:
     /**
      * trigger update of session list
+     * @param synchronous read new or changed session files at once instead of in the background
+     */
+    void updateSessionList(bool synchronous = false);
+
+    /**
+     * take over the session file infos read in the background
      */
-    void updateSessionList();
+    void applySessionScan();
+
+    /**
+     * periodic save of the active session, for crash safety
+     */
+    void autoSaveActiveSession();
 
 private:
     /**
@@ -178,14 +202,41 @@ private:
 
     /**
       * helper function to save the session to a given config object
+      * @param sc config to save to
+      * @param async write the file in the background
       */
-    void saveSessionTo(KConfig *sc) const;
+    void saveSessionTo(KConfig *sc, bool async = false);
 
     /**
      * restore sessions documents, windows, etc...
      */
     void loadSession(const KateSession::Ptr &session) const;
 
+    /**
+     * infos about one session file, as kept in the session index
+     */
+    struct SessionFileInfo {
+        qint64 mtime;
+        qint64 size;
+        unsigned int documents;
+    };
+
+    /**
+     * read the infos of a session file, usable from any thread
+     */
+    static SessionFileInfo readSessionFileInfo(const QString &file);
+
+    /**
+     * load the session index from the cache
+     * @return success, false if there is no usable index
+     */
+    bool loadSessionIndex();
+
+    /**
+     * write the session index to the cache
+     */
+    void saveSessionIndex() const;
+
 private:
     /**
      * absolute path to dir in home dir where to store the sessions
@@ -203,6 +254,32 @@ private:
     KateSession::Ptr m_activeSession;
 
     class KDirWatch *m_dirWatch;
+
+    /**
+     * session index: infos of all session files by file name, cached between runs
+     * valid without listing the dir as long as the dir modification time did not change
+     */
+    QString m_sessionIndexFile;
+    QHash<QString, SessionFileInfo> m_sessionIndex;
+    qint64 m_sessionIndexDirTime;
+
+    /**
+     * background reading of new or changed session files
+     */
+    QThreadPool m_sessionScanner;
+    QMutex m_sessionScanMutex;
+    QHash<QString, SessionFileInfo> m_sessionScanResults;
+
+    /**
+     * writes session files off the gui thread, one after the other
+     */
+    QThreadPool m_sessionWriter;
+    class QTimer *m_autoSaveTimer;
+
+    /**
+     * documents get closed and loaded, no autosave now
+     */
+    bool m_activatingSession;
 };
 
 #endif
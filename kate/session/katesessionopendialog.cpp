@@ -66,6 +66,7 @@ KateSessionOpenDialog::KateSessionOpenDialog(QWidget *parent)
 
     connect(m_sessions, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)), this, SLOT(selectionChanged(QTreeWidgetItem*,QTreeWidgetItem*)));
     connect(m_sessions, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(slotOpen()));
+    connect(KateApp::self()->sessionManager(), SIGNAL(sessionListChanged()), this, SLOT(updateDocuments()));
 
     // buttons
     QDialogButtonBox *buttons = new QDialogButtonBox(this);
@@ -115,3 +116,9 @@ void KateSessionOpenDialog::selectionChanged(QTreeWidgetItem *current, QTreeWidg
     m_openButton->setEnabled(true);
 }
 
+void KateSessionOpenDialog::updateDocuments()
+{
+    for (int i = 0; i < m_sessions->topLevelItemCount(); ++i) {
+        static_cast<KateSessionChooserItem *>(m_sessions->topLevelItem(i))->updateDocuments();
+    }
+}
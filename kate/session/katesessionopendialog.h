@@ -53,6 +53,11 @@ protected Q_SLOTS:
      */
     void selectionChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
 
+    /**
+     * document counts might have been read in the background
+     */
+    void updateDocuments();
+
 private:
     QTreeWidget *m_sessions;
     QPushButton *m_openButton;